@@ -1,9 +1,10 @@
 // ============================================================================
 // HOMINK SENSOR DEFINITIONS
 // ============================================================================
-// To add a sensor: Add S_* define + SENSOR_* entry + YAML block with id: _varname
+// To add a sensor: Add S_* define + SENSOR_LIST entry + YAML block with id: _varname
 
 #include "homink_sensor.h"
+#include "homink_display.h"  // Enum vocabularies (LockState, ChargerState, WeatherCondition)
 
 // Sensor name definitions (ESPHome auto-generates id with _ prefix)
 
@@ -21,42 +22,40 @@
 #define S_HOME_CONSUMPTION home_consumption
 #define S_WIFI_RSSI        wifi_rssi
 
-// Sensor declarations (format: SENSOR_TYPE(var, "Display Name", "entity_id", [threshold]))
-// Binary sensors
-SENSOR_BINARY(S_GATE1, "Sidewalk", "binary_sensor.aqara_door_and_window_sensor_p2_door_2")
-SENSOR_BINARY(S_GATE2, "Driveway", "binary_sensor.aqara_door_and_window_sensor_p2_door_3")
-SENSOR_BINARY(S_GATE3, "Side", "binary_sensor.aqara_door_and_window_sensor_p2_door")
-
-// Text sensors
-SENSOR_TEXT(S_LOCK, "Lock", "lock.shed_lock")
-SENSOR_TEXT(S_WEATHER, "Weather", "sensor.openweathermap_condition")
-SENSOR_TEXT_FILTERED(S_CHARGER, "Charger", "sensor.tesla_wall_connector_status", "unavailable")
-
-// Threshold sensors
-SENSOR_THRESHOLD(S_TEMPERATURE, "Temperature", "sensor.birgenshire_temp", 1.0)
-SENSOR_THRESHOLD(S_SOLAR_POWER, "Solar Output", "sensor.birgenshire_solar_power", 0.5)
-SENSOR_THRESHOLD(S_CHARGING_POWER, "Charging", "sensor.tesla_wall_connector_current_power", 100.0)
-
-// Passive sensors (track HA connection, never trigger updates)
-SENSOR_PASSIVE(S_SUN_ELEV, "Sun Elevation", "sun.sun")
-SENSOR_PASSIVE(S_SOLAR_ENERGY, "Solar 24hr", "sensor.solar_production_last_24h_2")
-SENSOR_PASSIVE(S_HOME_CONSUMPTION, "Home 24hr", "sensor.home_consumption_last_24h_2")
-
-// WiFi sensor (ESPHome built-in)
-SENSOR_WIFI(S_WIFI_RSSI, "WiFi Signal", "wifisignal")
-
-// Init macro - links C++ sensors to ESPHome sensors (call in on_boot lambda)
-#define SENSOR_INIT_ALL() \
-  SENSOR_INIT_BINARY(S_GATE1) \
-  SENSOR_INIT_BINARY(S_GATE2) \
-  SENSOR_INIT_BINARY(S_GATE3) \
-  SENSOR_INIT_TEXT(S_LOCK) \
-  SENSOR_INIT_TEXT(S_WEATHER) \
-  SENSOR_INIT_TEXT_FILTERED(S_CHARGER) \
-  SENSOR_INIT_THRESHOLD(S_TEMPERATURE) \
-  SENSOR_INIT_THRESHOLD(S_SOLAR_POWER) \
-  SENSOR_INIT_THRESHOLD(S_CHARGING_POWER) \
-  SENSOR_INIT_PASSIVE(S_SUN_ELEV) \
-  SENSOR_INIT_PASSIVE(S_SOLAR_ENERGY) \
-  SENSOR_INIT_PASSIVE(S_HOME_CONSUMPTION) \
-  SENSOR_INIT_WIFI(S_WIFI_RSSI)
+// Sensor list - one entry per sensor (format: X(SENSOR_TYPE, var, sections, "Display Name", "entity_id", [args]))
+// SENSOR_REGISTRY() expands it into the declarations, the Sensors registry and SENSOR_INIT_ALL()
+#define SENSOR_LIST(X) \
+  /* Binary sensors */ \
+  X(SENSOR_BINARY, S_GATE1, SECTION_GATE1, "Sidewalk", "binary_sensor.aqara_door_and_window_sensor_p2_door_2") \
+  X(SENSOR_BINARY, S_GATE2, SECTION_GATE2, "Driveway", "binary_sensor.aqara_door_and_window_sensor_p2_door_3") \
+  X(SENSOR_BINARY, S_GATE3, SECTION_GATE3, "Side", "binary_sensor.aqara_door_and_window_sensor_p2_door") \
+  /* Text sensors (parsed into enums once per push) */ \
+  X(SENSOR_TEXT_ENUM, S_LOCK, SECTION_GATE3, "Lock", "lock.shed_lock", LockState) \
+  X(SENSOR_TEXT_ENUM, S_WEATHER, SECTION_WEATHER, "Weather", "sensor.openweathermap_condition", WeatherCondition) \
+  X(SENSOR_TEXT_ENUM_FILTERED, S_CHARGER, SECTION_CHARGING, "Charger", "sensor.tesla_wall_connector_status", ChargerState, ChargerState::UNAVAILABLE) \
+  /* Threshold sensors (smoothed: filter, rise band, fall band, hold seconds) */ \
+  X(SENSOR_THRESHOLD, S_TEMPERATURE, SECTION_WEATHER, "Temperature", "sensor.birgenshire_temp", 1.0) \
+  X(SENSOR_THRESHOLD_EMA, S_SOLAR_POWER, SECTION_SOLAR_OUTPUT, "Solar Output", "sensor.birgenshire_solar_power", 0.3, 0.5, 0.5, 120) \
+  X(SENSOR_THRESHOLD_MEDIAN, S_CHARGING_POWER, SECTION_CHARGING, "Charging", "sensor.tesla_wall_connector_current_power", 3, 100.0, 100.0, 30) \
+  /* Passive sensors (track HA connection, never trigger updates) */ \
+  X(SENSOR_PASSIVE, S_SUN_ELEV, SECTION_WEATHER, "Sun Elevation", "sun.sun") \
+  X(SENSOR_PASSIVE, S_SOLAR_ENERGY, SECTION_SOLAR_24HR, "Solar 24hr", "sensor.solar_production_last_24h_2") \
+  X(SENSOR_PASSIVE, S_HOME_CONSUMPTION, SECTION_HOME_24HR, "Home 24hr", "sensor.home_consumption_last_24h_2") \
+  /* WiFi sensor (ESPHome built-in) */ \
+  X(SENSOR_WIFI, S_WIFI_RSSI, SECTION_WEATHER, "WiFi Signal", "wifisignal")
+
+SENSOR_REGISTRY()
+
+// Staleness budgets - seconds without a push before the backup poll re-requests the entity
+// (sensors not listed use stale_after_seconds from the device YAML)
+#define SENSOR_STALENESS_ALL() \
+  SENSOR_STALE_AFTER(S_SUN_ELEV, 300) \
+  SENSOR_STALE_AFTER(S_SOLAR_ENERGY, 300) \
+  SENSOR_STALE_AFTER(S_HOME_CONSUMPTION, 300)
+
+// Display quantizers - mirror the display lambda's expression and format string so a change is
+// only significant when the rendered text changes: SENSOR_QUANTIZE(var, format, scale, divisor, floor, idle)
+#define SENSOR_QUANTIZERS_ALL() \
+  SENSOR_QUANTIZE(S_TEMPERATURE, "%.0f", 1.0f, 1.0, -INFINITY, -INFINITY)   /* "%.0f°F" */ \
+  SENSOR_QUANTIZE(S_SOLAR_POWER, "%.1f", 1.0f, 1.0, 0.0f, -INFINITY)        /* "%.1f kW", negative shown as 0 */ \
+  SENSOR_QUANTIZE(S_CHARGING_POWER, "%.1f", id(tesla_power_factor), 1000.0, -INFINITY, 100.0f)  /* (W x power factor) / 1000.0 as "%.1f kW", idle at <= 100W */
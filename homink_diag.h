@@ -0,0 +1,349 @@
+#pragma once
+
+#include "esphome.h"
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// ============================================================================
+// ALLOCATION COUNTER
+// ============================================================================
+// Global operator new/delete replacements that count every C++ heap allocation
+// (and the bytes requested) in the firmware. Take allocation_count() before and
+// after a code path to prove it allocates nothing (sensor callbacks, display lambda).
+// malloc() calls from C code (lwIP, IDF) are not counted.
+//
+// The whole replaceable set is defined (plain, nothrow, aligned and their sized
+// deletes), so no form slips past the count or pairs with the library's operator.
+// Build with -DHOMINK_COUNT_ALLOCATIONS=0 (count_allocations: "0") to keep the
+// toolchain's operators; the counters then stay at 0.
+
+#ifndef HOMINK_COUNT_ALLOCATIONS
+#define HOMINK_COUNT_ALLOCATIONS 1
+#endif
+
+namespace homink_diag {
+
+// Constant-initialized, so it is valid for allocations made during static init
+inline std::atomic<uint32_t> allocations{0};
+inline std::atomic<uint32_t> allocated_bytes{0};
+
+inline uint32_t allocation_count() { return allocations.load(std::memory_order_relaxed); }
+inline uint32_t allocation_bytes() { return allocated_bytes.load(std::memory_order_relaxed); }
+
+// Allocations made inside SENSOR_UPDATE_CALLBACK change detection (cumulative)
+inline uint32_t callback_allocations = 0;
+
+// SENSOR_UPDATE_CALLBACK change detection cost (cumulative, microseconds)
+inline uint32_t callback_count = 0;
+inline uint64_t callback_total_us = 0;
+inline uint32_t callback_max_us = 0;
+
+inline void record_callback(uint32_t us) {
+  callback_count++;
+  callback_total_us += us;
+  if (us > callback_max_us) callback_max_us = us;
+}
+
+inline float callback_avg_us() { return callback_count ? float(callback_total_us) / callback_count : 0.0f; }
+
+#if HOMINK_COUNT_ALLOCATIONS
+// Counted malloc behind every operator new; null only for the nothrow forms
+inline void *counted_alloc(size_t size, size_t align, bool nothrow) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (!size) size = 1;
+  // aligned_alloc() wants a multiple of the alignment; free() releases both kinds
+  void *p = align ? std::aligned_alloc(align, (size + align - 1) / align * align) : std::malloc(size);
+  if (!p && !nothrow) std::abort();  // Built without exceptions - same as the library operator
+  return p;
+}
+#endif
+
+}  // namespace homink_diag
+
+#if HOMINK_COUNT_ALLOCATIONS
+using homink_diag::counted_alloc;
+
+void *operator new(size_t size) { return counted_alloc(size, 0, false); }
+void *operator new[](size_t size) { return counted_alloc(size, 0, false); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size, 0, true); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size, 0, true); }
+void *operator new(size_t size, std::align_val_t al) { return counted_alloc(size, size_t(al), false); }
+void *operator new[](size_t size, std::align_val_t al) { return counted_alloc(size, size_t(al), false); }
+void *operator new(size_t size, std::align_val_t al, const std::nothrow_t &) noexcept {
+  return counted_alloc(size, size_t(al), true);
+}
+void *operator new[](size_t size, std::align_val_t al, const std::nothrow_t &) noexcept {
+  return counted_alloc(size, size_t(al), true);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+#endif
+
+// ============================================================================
+// REFRESH LATENCY
+// ============================================================================
+// Microsecond timing of every update_screen phase, kept as rolling min/avg/max
+// over the last LATENCY_WINDOW refreshes and exported as diagnostic sensors.
+// END_TO_END runs from the SENSOR_UPDATE_CALLBACK that first marked a change
+// dirty to the panel reporting done, so it includes the min interval,
+// coalesce window and budget deferrals.
+
+namespace homink_diag {
+
+constexpr uint8_t LATENCY_WINDOW = 16;
+
+class LatencyWindow {
+public:
+  void add(uint32_t us) {
+    _samples[_next] = us;
+    _next = (_next + 1) % LATENCY_WINDOW;
+    if (_count < LATENCY_WINDOW) _count++;
+  }
+
+  uint8_t count() const { return _count; }
+
+  // Milliseconds for the sensors, NAN until the first sample
+  float min_ms() const {
+    if (!_count) return NAN;
+    uint32_t m = _samples[0];
+    for (uint8_t i = 1; i < _count; i++) m = std::min(m, _samples[i]);
+    return m / 1000.0f;
+  }
+  float max_ms() const {
+    if (!_count) return NAN;
+    uint32_t m = _samples[0];
+    for (uint8_t i = 1; i < _count; i++) m = std::max(m, _samples[i]);
+    return m / 1000.0f;
+  }
+  float avg_ms() const {
+    if (!_count) return NAN;
+    uint64_t sum = 0;
+    for (uint8_t i = 0; i < _count; i++) sum += _samples[i];
+    return sum / 1000.0f / _count;
+  }
+
+private:
+  uint32_t _samples[LATENCY_WINDOW]{};
+  uint8_t _next{0};
+  uint8_t _count{0};
+};
+
+enum RefreshPhase : uint8_t {
+  PHASE_HA_REQUEST,  // Build the entity list and send homeassistant.update_entity
+  PHASE_HA_WAIT,     // Barrier until every entity answered (or timeout)
+  PHASE_CACHE,       // Sensors::update_all()
+  PHASE_RENDER,      // Static layer restore + display lambda
+  PHASE_TRANSFER,    // Panel wake + SPI frame transfer
+  PHASE_BUSY_WAIT,   // Panel refresh (BUSY held)
+  PHASE_END_TO_END,  // Triggering callback -> panel done
+  PHASE_COUNT
+};
+
+inline const char *phase_name(RefreshPhase phase) {
+  switch (phase) {
+    case PHASE_HA_REQUEST: return "HA request";
+    case PHASE_HA_WAIT: return "HA wait";
+    case PHASE_CACHE: return "cache";
+    case PHASE_RENDER: return "render";
+    case PHASE_TRANSFER: return "transfer";
+    case PHASE_BUSY_WAIT: return "busy wait";
+    case PHASE_END_TO_END: return "end to end";
+    default: return "?";
+  }
+}
+
+class RefreshTimer {
+public:
+  // First significant change since the last refresh took the dirty flags
+  void note_trigger() {
+    if (!_trigger_pending) {
+      _trigger_pending = true;
+      _trigger_us = micros();
+      _trigger_ms = millis();
+    }
+  }
+
+  // Refresh takes the dirty flags - its changes are the ones this refresh shows
+  void take_trigger() {
+    _active = _trigger_pending;
+    _active_us = _trigger_us;
+    _active_ms = _trigger_ms;
+    _trigger_pending = false;
+  }
+
+  // Phase boundaries: start() opens the first phase, mark() closes the current one and opens the next
+  void start() { _phase_start_us = micros(); }
+  void mark(RefreshPhase phase) {
+    uint32_t now = micros();
+    add(phase, now - _phase_start_us);
+    _phase_start_us = now;
+  }
+
+  void add(RefreshPhase phase, uint32_t us) { _phases[phase].add(us); }
+
+  // Panel done - close the end-to-end measurement of the changes this refresh showed
+  void finish() {
+    if (!_active) return;
+    _active = false;
+    // micros() wraps after ~71 minutes; a change deferred that long saturates
+    bool wrapped = millis() - _active_ms >= UINT32_MAX / 1000;
+    add(PHASE_END_TO_END, wrapped ? UINT32_MAX : micros() - _active_us);
+  }
+
+  const LatencyWindow &phase(RefreshPhase phase) const { return _phases[phase]; }
+
+  // Every phase as min/avg/max ("Log Sensor Stats") - the sensors only export a summary
+  void log() const {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      const LatencyWindow &w = _phases[i];
+      ESP_LOGI("sensor", "  %-11s %8.1f / %8.1f / %8.1f ms (%u refreshes)", phase_name(RefreshPhase(i)),
+               w.min_ms(), w.avg_ms(), w.max_ms(), (unsigned) w.count());
+    }
+  }
+
+private:
+  LatencyWindow _phases[PHASE_COUNT];
+  uint32_t _phase_start_us{0};
+  bool _trigger_pending{false};
+  uint32_t _trigger_us{0};
+  uint32_t _trigger_ms{0};
+  bool _active{false};
+  uint32_t _active_us{0};
+  uint32_t _active_ms{0};
+};
+
+inline RefreshTimer refresh_timer;
+
+}  // namespace homink_diag
+
+// ============================================================================
+// HEAP AND STACK HEALTH
+// ============================================================================
+// Long-uptime fragmentation shows up as the largest free block shrinking while free
+// heap stays flat. RefreshAllocations brackets one update_screen run (start -> panel
+// done) - everything allocated meanwhile, including API and callback work in the
+// main loop - so a regression shows up as a step in its counts.
+
+namespace homink_diag {
+
+// Internal RAM (where lwIP, the API and std::string live)
+inline uint32_t free_heap() { return heap_caps_get_free_size(MALLOC_CAP_INTERNAL); }
+inline uint32_t largest_free_block() { return heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL); }
+inline uint32_t min_free_heap() { return heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL); }
+inline uint32_t free_psram() { return heap_caps_get_free_size(MALLOC_CAP_SPIRAM); }  // 0 without PSRAM
+
+// Unused loop-task stack at its deepest so far (bytes on ESP-IDF). Call from the main
+// loop - sensor lambdas run there.
+inline uint32_t loop_stack_free() { return uxTaskGetStackHighWaterMark(nullptr); }
+
+class RefreshAllocations {
+public:
+  void begin() {
+    _count_start = allocation_count();
+    _bytes_start = allocation_bytes();
+  }
+  void end() {
+    _count = allocation_count() - _count_start;
+    _bytes = allocation_bytes() - _bytes_start;
+  }
+
+  uint32_t count() const { return _count; }  // Last refresh
+  uint32_t bytes() const { return _bytes; }
+
+private:
+  uint32_t _count_start{0};
+  uint32_t _bytes_start{0};
+  uint32_t _count{0};
+  uint32_t _bytes{0};
+};
+
+inline RefreshAllocations refresh_allocations;
+
+}  // namespace homink_diag
+
+// ============================================================================
+// SENSOR TRACE
+// ============================================================================
+// Fixed-size binary ring of SENSOR_UPDATE_CALLBACK decisions: 16 bytes per push,
+// no formatting on the hot path. Sensors::dump_trace() ("Dump Sensor Trace"
+// button) formats it on demand, oldest first. Pair with
+// HOMINK_VERBOSE_SENSOR_LOG=0 (homink_sensor.h) to drop the per-push log lines.
+
+namespace homink_diag {
+
+enum class TraceDecision : uint8_t {
+  IMMEDIATE,        // Significant - armed schedule_refresh
+  DEFERRED,         // Significant - folded into an armed refresh or the sync window
+  PENDING,          // Already dirty, not re-checked until the next refresh
+  HIDDEN,           // Not drawn on the current page - cached, no refresh
+  IGNORED,          // Filtered transition (to/from an ignored state)
+  BELOW_THRESHOLD,  // Not significant (threshold, quantizer, band or hold)
+};
+
+inline const char *trace_decision_name(TraceDecision decision) {
+  switch (decision) {
+    case TraceDecision::IMMEDIATE: return "immediate";
+    case TraceDecision::DEFERRED: return "deferred";
+    case TraceDecision::PENDING: return "pending";
+    case TraceDecision::HIDDEN: return "hidden";
+    case TraceDecision::IGNORED: return "ignored";
+    case TraceDecision::BELOW_THRESHOLD: return "below threshold";
+  }
+  return "?";
+}
+
+struct TraceEntry {
+  uint32_t ms;
+  uint16_t sensor;  // SENSOR_LIST position
+  TraceDecision decision;
+  float old_value;  // Cached value before the push (NAN for strings)
+  float new_value;  // Pushed value as compared (NAN for strings)
+};
+
+constexpr uint16_t TRACE_ENTRIES = 128;
+
+class TraceRing {
+public:
+  void record(uint16_t sensor, TraceDecision decision, float old_value, float new_value) {
+    _entries[_next] = TraceEntry{millis(), sensor, decision, old_value, new_value};
+    _next = (_next + 1) % TRACE_ENTRIES;
+    if (_count < TRACE_ENTRIES) _count++;
+  }
+
+  // f(entry) for every entry, oldest first
+  template<typename F> void for_each(F &&f) const {
+    uint16_t first = (_next + TRACE_ENTRIES - _count) % TRACE_ENTRIES;
+    for (uint16_t i = 0; i < _count; i++) f(_entries[(first + i) % TRACE_ENTRIES]);
+  }
+
+  uint16_t count() const { return _count; }
+  void clear() { _count = 0; }
+
+private:
+  TraceEntry _entries[TRACE_ENTRIES]{};
+  uint16_t _next{0};
+  uint16_t _count{0};
+};
+
+inline TraceRing trace;
+
+}  // namespace homink_diag
@@ -0,0 +1,1158 @@
+#pragma once
+
+#include "esphome.h"
+#include "homink_diag.h"
+#include "homink_sensor.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// ============================================================================
+// DISPLAY LAYOUT
+// ============================================================================
+// Portrait coordinates (after the 90° rotation). Shared by the display lambda
+// and the partial-refresh engine so refresh windows always match what is drawn.
+// See "Display Layout & Constraints" in CLAUDE.md before changing any value.
+namespace homink_layout {
+
+// Display boundaries (visible area within frame)
+constexpr int DISPLAY_WIDTH = 480;
+constexpr int DISPLAY_HEIGHT = 800;
+constexpr int VISIBLE_Y_MIN = 60;
+constexpr int VISIBLE_Y_MAX = 741;
+
+// X positions (horizontal layout)
+constexpr int X_CENTER = 240;
+constexpr int X_LEFT_MARGIN = 40;
+constexpr int X_RIGHT_MARGIN = 440;
+constexpr int X_ROW_ICON = 60;
+constexpr int X_ROW_LABEL = 120;
+constexpr int X_ROW_VALUE = 420;
+constexpr int X_WIFI_ICON = 448;
+
+// Section title Y positions
+constexpr int Y_WEATHER_TITLE = 85;
+constexpr int Y_ENERGY_TITLE = 268;
+constexpr int Y_GATES_TITLE = 521;
+
+// Weather section
+constexpr int Y_WEATHER_CONTENT = 140;
+constexpr int X_WEATHER_ICON = 100;
+constexpr int X_TEMPERATURE = 300;
+constexpr int Y_WIFI_ICON = 70;
+
+// Divider lines
+constexpr int Y_DIVIDER_1 = 250;
+constexpr int Y_DIVIDER_2 = 503;
+
+// Energy section row Y positions (icon is ~3px above label/value for visual alignment)
+constexpr int Y_SOLAR_OUTPUT_ICON = 339;
+constexpr int Y_SOLAR_OUTPUT_TEXT = 342;
+constexpr int Y_SOLAR_24HR_ICON = 382;
+constexpr int Y_SOLAR_24HR_TEXT = 385;
+constexpr int Y_HOME_24HR_ICON = 425;
+constexpr int Y_HOME_24HR_TEXT = 428;
+constexpr int Y_CHARGING_ICON = 468;
+constexpr int Y_CHARGING_TEXT = 471;
+
+// Gates section row Y positions
+constexpr int Y_GATE1_ICON = 592;
+constexpr int Y_GATE1_TEXT = 595;
+constexpr int Y_GATE2_ICON = 640;
+constexpr int Y_GATE2_TEXT = 643;
+constexpr int Y_GATE3_ICON = 688;
+constexpr int Y_GATE3_TEXT = 691;
+
+// Footer
+constexpr int Y_FOOTER = 721;
+
+// Half the row pitch - a row owns everything within this distance of its icon
+constexpr int ENERGY_ROW_HALF_HEIGHT = 21;  // Rows are 43px apart
+constexpr int GATE_ROW_HALF_HEIGHT = 24;    // Rows are 48px apart
+
+}  // namespace homink_layout
+
+// ============================================================================
+// DISPLAY SECTIONS
+// ============================================================================
+// Horizontal bands of the portrait layout that can change between refreshes.
+// Titles and dividers outside these bands are static and only ever redrawn
+// by a full refresh.
+
+enum DisplaySection : uint32_t {
+  SECTION_NONE         = 0,
+  SECTION_WEATHER      = 1u << 0,
+  SECTION_SOLAR_OUTPUT = 1u << 1,
+  SECTION_SOLAR_24HR   = 1u << 2,
+  SECTION_HOME_24HR    = 1u << 3,
+  SECTION_CHARGING     = 1u << 4,
+  SECTION_GATE1        = 1u << 5,
+  SECTION_GATE2        = 1u << 6,
+  SECTION_GATE3        = 1u << 7,
+  SECTION_FOOTER       = 1u << 8,
+  SECTION_ALL          = (1u << 9) - 1,
+};
+
+struct SectionBand {
+  DisplaySection section;
+  const char *name;
+  int y_min;  // Inclusive, portrait coordinates
+  int y_max;  // Exclusive
+};
+
+// Ordered top to bottom - the window merge in PanelRefresh relies on this
+constexpr SectionBand SECTION_BANDS[] = {
+  {SECTION_WEATHER, "weather", homink_layout::VISIBLE_Y_MIN, homink_layout::Y_DIVIDER_1},
+  {SECTION_SOLAR_OUTPUT, "solar output",
+   homink_layout::Y_SOLAR_OUTPUT_ICON - homink_layout::ENERGY_ROW_HALF_HEIGHT,
+   homink_layout::Y_SOLAR_OUTPUT_ICON + homink_layout::ENERGY_ROW_HALF_HEIGHT + 1},
+  {SECTION_SOLAR_24HR, "solar 24hr",
+   homink_layout::Y_SOLAR_24HR_ICON - homink_layout::ENERGY_ROW_HALF_HEIGHT,
+   homink_layout::Y_SOLAR_24HR_ICON + homink_layout::ENERGY_ROW_HALF_HEIGHT + 1},
+  {SECTION_HOME_24HR, "home 24hr",
+   homink_layout::Y_HOME_24HR_ICON - homink_layout::ENERGY_ROW_HALF_HEIGHT,
+   homink_layout::Y_HOME_24HR_ICON + homink_layout::ENERGY_ROW_HALF_HEIGHT + 1},
+  {SECTION_CHARGING, "charging",
+   homink_layout::Y_CHARGING_ICON - homink_layout::ENERGY_ROW_HALF_HEIGHT,
+   homink_layout::Y_CHARGING_ICON + homink_layout::ENERGY_ROW_HALF_HEIGHT + 1},
+  {SECTION_GATE1, "gate 1",
+   homink_layout::Y_GATE1_ICON - homink_layout::GATE_ROW_HALF_HEIGHT,
+   homink_layout::Y_GATE1_ICON + homink_layout::GATE_ROW_HALF_HEIGHT},
+  {SECTION_GATE2, "gate 2",
+   homink_layout::Y_GATE2_ICON - homink_layout::GATE_ROW_HALF_HEIGHT,
+   homink_layout::Y_GATE2_ICON + homink_layout::GATE_ROW_HALF_HEIGHT},
+  {SECTION_GATE3, "gate 3",
+   homink_layout::Y_GATE3_ICON - homink_layout::GATE_ROW_HALF_HEIGHT,
+   homink_layout::Y_GATE3_ICON + homink_layout::GATE_ROW_HALF_HEIGHT},
+  {SECTION_FOOTER, "footer",
+   homink_layout::Y_GATE3_ICON + homink_layout::GATE_ROW_HALF_HEIGHT, homink_layout::VISIBLE_Y_MAX + 1},
+};
+
+constexpr int SECTION_COUNT = sizeof(SECTION_BANDS) / sizeof(SECTION_BANDS[0]);
+
+// ============================================================================
+// REFRESH BUDGET
+// ============================================================================
+// Token bucket limiting how often cosmetic changes may refresh the panel. The
+// bucket state lives in restored globals (refresh_budget_tokens/_time).
+
+// Changes drawn here (gates, lock) always refresh, even with an empty bucket
+constexpr uint32_t SECTION_BUDGET_EXEMPT = SECTION_GATE1 | SECTION_GATE2 | SECTION_GATE3;
+
+// Tokens after elapsed_s seconds: per_hour accrue per hour, capped at burst
+inline float refill_refresh_budget(float tokens, long elapsed_s, float per_hour, float burst) {
+  if (elapsed_s > 0) tokens += elapsed_s * per_hour / 3600.0f;  // Clock went backward: no refill
+  return std::min(tokens, burst);
+}
+
+// ============================================================================
+// WEATHER ICONS
+// ============================================================================
+// Home Assistant / OpenWeatherMap condition -> MDI glyph. Sorted by strcmp()
+// for binary search: no heap, no string copies, checked at compile time.
+
+// Glyphs substituted by time of day (must be declared in font_mdi_large)
+constexpr const char *MDI_WEATHER_NIGHT = "\U000F0594";
+constexpr const char *MDI_WEATHER_NIGHT_PARTLY_CLOUDY = "\U000F0F31";
+constexpr const char *MDI_WEATHER_SUNSET = "\U000F059A";
+constexpr const char *MDI_ALERT_CIRCLE_OUTLINE = "\U000F0026";  // Unknown condition
+
+// How a condition's icon changes with time of day
+enum class WeatherClass : uint8_t {
+  FIXED,          // Same icon day and night
+  CLEAR,          // Sunset icon in golden hour, moon at night
+  PARTLY_CLOUDY,  // Night partly cloudy icon at night
+};
+
+struct WeatherIcon {
+  const char *condition;
+  const char *glyph;
+  WeatherClass cls;
+};
+
+constexpr WeatherIcon WEATHER_ICONS[] = {
+  {"ash",                  "\U000F0591", WeatherClass::FIXED},         // weather-fog
+  {"broken_clouds",        "\U000F0590", WeatherClass::PARTLY_CLOUDY}, // weather-cloudy
+  {"clear",                "\U000F0599", WeatherClass::CLEAR},         // weather-sunny
+  {"clear-night",          "\U000F0594", WeatherClass::FIXED},         // weather-night
+  {"clear_day",            "\U000F0599", WeatherClass::CLEAR},         // weather-sunny
+  {"clear_night",          "\U000F0594", WeatherClass::CLEAR},         // weather-night
+  {"clearsky",             "\U000F0599", WeatherClass::CLEAR},         // weather-sunny
+  {"cloudy",               "\U000F0590", WeatherClass::FIXED},         // weather-cloudy
+  {"cloudy-alert",         "\U000F0F2F", WeatherClass::FIXED},         // weather-cloudy-alert
+  {"drizzle",              "\U000F0597", WeatherClass::FIXED},         // weather-rainy
+  {"dust",                 "\U000F0F30", WeatherClass::FIXED},         // weather-hazy
+  {"few_clouds",           "\U000F0595", WeatherClass::PARTLY_CLOUDY}, // weather-partly-cloudy
+  {"fog",                  "\U000F0591", WeatherClass::FIXED},         // weather-fog
+  {"hail",                 "\U000F0592", WeatherClass::FIXED},         // weather-hail
+  {"haze",                 "\U000F0F30", WeatherClass::FIXED},         // weather-hazy
+  {"hazy",                 "\U000F0F30", WeatherClass::FIXED},         // weather-hazy
+  {"hurricane",            "\U000F0898", WeatherClass::FIXED},         // weather-hurricane
+  {"lightning",            "\U000F0593", WeatherClass::FIXED},         // weather-lightning
+  {"lightning-rainy",      "\U000F067E", WeatherClass::FIXED},         // weather-lightning-rainy
+  {"mist",                 "\U000F0591", WeatherClass::FIXED},         // weather-fog
+  {"night",                "\U000F0594", WeatherClass::FIXED},         // weather-night
+  {"night-partly-cloudy",  "\U000F0F31", WeatherClass::FIXED},         // weather-night-partly-cloudy
+  {"partly-cloudy",        "\U000F0595", WeatherClass::PARTLY_CLOUDY}, // weather-partly-cloudy
+  {"partlycloudy",         "\U000F0595", WeatherClass::PARTLY_CLOUDY}, // weather-partly-cloudy
+  {"pouring",              "\U000F0596", WeatherClass::FIXED},         // weather-pouring
+  {"rain",                 "\U000F0597", WeatherClass::FIXED},         // weather-rainy
+  {"rainy",                "\U000F0597", WeatherClass::FIXED},         // weather-rainy
+  {"scattered_clouds",     "\U000F0595", WeatherClass::PARTLY_CLOUDY}, // weather-partly-cloudy
+  {"shower_rain",          "\U000F0597", WeatherClass::FIXED},         // weather-rainy
+  {"smoke",                "\U000F0591", WeatherClass::FIXED},         // weather-fog
+  {"snow",                 "\U000F0598", WeatherClass::FIXED},         // weather-snowy
+  {"snowy",                "\U000F0598", WeatherClass::FIXED},         // weather-snowy
+  {"snowy-heavy",          "\U000F0F36", WeatherClass::FIXED},         // weather-snowy-heavy
+  {"snowy-rainy",          "\U000F067F", WeatherClass::FIXED},         // weather-snowy-rainy
+  {"squall",               "\U000F059D", WeatherClass::FIXED},         // weather-windy
+  {"sunny",                "\U000F0599", WeatherClass::CLEAR},         // weather-sunny
+  {"sunset",               "\U000F059A", WeatherClass::FIXED},         // weather-sunset
+  {"thunderstorm",         "\U000F0593", WeatherClass::FIXED},         // weather-lightning
+  {"tornado",              "\U000F0F38", WeatherClass::FIXED},         // weather-tornado
+  {"windy",                "\U000F059D", WeatherClass::FIXED},         // weather-windy
+};
+
+constexpr int WEATHER_ICON_COUNT = sizeof(WEATHER_ICONS) / sizeof(WEATHER_ICONS[0]);
+
+constexpr int weather_strcmp(const char *a, const char *b) {
+  while (*a && *a == *b) {
+    a++;
+    b++;
+  }
+  return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+
+constexpr bool weather_icons_sorted() {
+  for (int i = 1; i < WEATHER_ICON_COUNT; i++) {
+    if (weather_strcmp(WEATHER_ICONS[i - 1].condition, WEATHER_ICONS[i].condition) >= 0) return false;
+  }
+  return true;
+}
+
+static_assert(weather_icons_sorted(), "WEATHER_ICONS must be sorted by condition (strcmp order)");
+
+// Table entry for a condition, or nullptr if unknown
+inline const WeatherIcon *find_weather_icon(const char *condition) {
+  int lo = 0;
+  int hi = WEATHER_ICON_COUNT - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    int cmp = std::strcmp(condition, WEATHER_ICONS[mid].condition);
+    if (cmp == 0) return &WEATHER_ICONS[mid];
+    if (cmp < 0) hi = mid - 1;
+    else lo = mid + 1;
+  }
+  return nullptr;
+}
+
+// Interned weather condition: index into WEATHER_ICONS (parsed once per push by EnumTextSensor)
+enum class WeatherCondition : uint8_t {
+  UNKNOWN = 0xFF,
+};
+
+static_assert(WEATHER_ICON_COUNT < static_cast<int>(WeatherCondition::UNKNOWN), "WEATHER_ICONS too large for WeatherCondition");
+
+template<>
+struct EnumTraits<WeatherCondition> {
+  static constexpr WeatherCondition UNKNOWN = WeatherCondition::UNKNOWN;
+  static constexpr int COUNT = WEATHER_ICON_COUNT;
+  static WeatherCondition parse(const char *text) {
+    const WeatherIcon *icon = find_weather_icon(text);
+    return icon ? static_cast<WeatherCondition>(icon - WEATHER_ICONS) : UNKNOWN;
+  }
+  static const char *name(WeatherCondition condition) {
+    return condition == UNKNOWN ? "unknown" : WEATHER_ICONS[static_cast<uint8_t>(condition)].condition;
+  }
+};
+
+// Glyph to draw for a condition, applying the day/night/sunset variants
+inline const char *weather_glyph(WeatherCondition condition, bool night, bool sunset) {
+  if (condition == WeatherCondition::UNKNOWN) return MDI_ALERT_CIRCLE_OUTLINE;
+  const WeatherIcon *icon = &WEATHER_ICONS[static_cast<uint8_t>(condition)];
+  switch (icon->cls) {
+    case WeatherClass::CLEAR:
+      if (sunset) return MDI_WEATHER_SUNSET;
+      if (night) return MDI_WEATHER_NIGHT;
+      break;
+    case WeatherClass::PARTLY_CLOUDY:
+      if (night) return MDI_WEATHER_NIGHT_PARTLY_CLOUDY;
+      break;
+    case WeatherClass::FIXED:
+      break;
+  }
+  return icon->glyph;
+}
+
+// ============================================================================
+// STATE VOCABULARIES
+// ============================================================================
+// HA text states the display distinguishes. Anything else parses to UNKNOWN.
+
+// lock.* entity
+enum class LockState : uint8_t {
+  LOCKED,
+  UNLOCKED,
+  LOCKING,
+  UNLOCKING,
+  JAMMED,
+  OPEN,
+  OPENING,
+  UNKNOWN,
+};
+
+constexpr EnumName<LockState> LOCK_STATES[] = {
+  {"locked",    LockState::LOCKED},
+  {"unlocked",  LockState::UNLOCKED},
+  {"locking",   LockState::LOCKING},
+  {"unlocking", LockState::UNLOCKING},
+  {"jammed",    LockState::JAMMED},
+  {"open",      LockState::OPEN},
+  {"opening",   LockState::OPENING},
+};
+
+template<>
+struct EnumTraits<LockState> {
+  static constexpr LockState UNKNOWN = LockState::UNKNOWN;
+  static constexpr int COUNT = static_cast<int>(LockState::UNKNOWN);
+  static LockState parse(const char *text) { return enum_from_text(LOCK_STATES, text, UNKNOWN); }
+  static const char *name(LockState state) { return enum_to_text(LOCK_STATES, state); }
+};
+
+// Tesla Wall Connector status sensor
+enum class ChargerState : uint8_t {
+  NOT_CONNECTED,
+  BOOTING,
+  CONNECTED,
+  READY,
+  NEGOTIATING,
+  CHARGING,
+  CHARGING_REDUCED,
+  CHARGING_FINISHED,
+  CHARGING_STOPPED,
+  WAITING_CAR,
+  SCHEDULED,
+  FAULT,  // "error" (avoids clashing with an ERROR macro)
+  UNAVAILABLE,
+  UNKNOWN,  // Unrecognized status - drawn as plugged in, not charging
+};
+
+constexpr EnumName<ChargerState> CHARGER_STATES[] = {
+  {"not_connected",     ChargerState::NOT_CONNECTED},
+  {"booting",           ChargerState::BOOTING},
+  {"connected",         ChargerState::CONNECTED},
+  {"ready",             ChargerState::READY},
+  {"negotiating",       ChargerState::NEGOTIATING},
+  {"charging",          ChargerState::CHARGING},
+  {"charging_reduced",  ChargerState::CHARGING_REDUCED},
+  {"charging_finished", ChargerState::CHARGING_FINISHED},
+  {"charging_stopped",  ChargerState::CHARGING_STOPPED},
+  {"waiting_car",       ChargerState::WAITING_CAR},
+  {"scheduled",         ChargerState::SCHEDULED},
+  {"error",             ChargerState::FAULT},
+  {"unavailable",       ChargerState::UNAVAILABLE},
+};
+
+template<>
+struct EnumTraits<ChargerState> {
+  static constexpr ChargerState UNKNOWN = ChargerState::UNKNOWN;
+  static constexpr int COUNT = static_cast<int>(ChargerState::UNKNOWN);
+  static ChargerState parse(const char *text) { return enum_from_text(CHARGER_STATES, text, UNKNOWN); }
+  static const char *name(ChargerState state) { return enum_to_text(CHARGER_STATES, state); }
+};
+
+// ============================================================================
+// GLYPH COVERAGE
+// ============================================================================
+// Fonts only declare the glyphs they render. ESPHome draws a box for a missing
+// one, so strings that come from configuration (sensor names) are checked on
+// boot instead of showing up as boxes on the panel.
+
+// Byte length of the UTF-8 sequence starting with lead
+inline int utf8_length(uint8_t lead) {
+  if (lead < 0x80) return 1;
+  if ((lead & 0xE0) == 0xC0) return 2;
+  if ((lead & 0xF0) == 0xE0) return 3;
+  if ((lead & 0xF8) == 0xF0) return 4;
+  return 1;
+}
+
+// Logs every character of text that font has no glyph for; false if any is missing
+inline bool check_glyphs(esphome::font::Font *font, const char *font_id, const char *text) {
+  bool complete = true;
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(text);
+  while (*p) {
+    int length = 1;
+    if (font->match_next_glyph(p, &length) < 0) {
+      length = utf8_length(*p);
+      ESP_LOGW("display", "%s has no glyph for '%.*s' (in \"%s\")", font_id, length, reinterpret_cast<const char *>(p), text);
+      complete = false;
+    }
+    p += length;
+  }
+  return complete;
+}
+
+// ============================================================================
+// PANEL GEOMETRY (7.50inv2 native orientation)
+// ============================================================================
+// The framebuffer is 800x480 landscape, 1 bit per pixel, MSB first. With
+// rotation: 90° a portrait pixel (x, y) lands at native (799 - y, x), so a
+// portrait band [y_min, y_max) is the native column range [800 - y_max, 800 - y_min)
+// across all 480 native rows.
+namespace homink_panel {
+
+constexpr int NATIVE_WIDTH = homink_layout::DISPLAY_HEIGHT;
+constexpr int NATIVE_HEIGHT = homink_layout::DISPLAY_WIDTH;
+constexpr int ROW_BYTES = NATIVE_WIDTH / 8;
+constexpr uint32_t FRAME_BYTES = ROW_BYTES * NATIVE_HEIGHT;
+
+// Native byte columns [first, last) covered by a portrait band (partial windows are 8px aligned)
+constexpr int band_first_byte(int y_max) { return (NATIVE_WIDTH - y_max) / 8; }
+constexpr int band_last_byte(int y_min) { return (NATIVE_WIDTH - y_min + 7) / 8; }
+
+// UC8179 controller commands used by the partial-refresh and sleep sequences
+constexpr uint8_t CMD_POWER_OFF = 0x02;
+constexpr uint8_t CMD_DEEP_SLEEP = 0x07;
+constexpr uint8_t DEEP_SLEEP_CHECK_CODE = 0xA5;
+constexpr uint8_t CMD_VCOM_DATA_INTERVAL = 0x50;
+constexpr uint8_t CMD_DATA_START_OLD = 0x10;
+constexpr uint8_t CMD_DATA_START_NEW = 0x13;
+constexpr uint8_t CMD_DISPLAY_REFRESH = 0x12;
+constexpr uint8_t CMD_PARTIAL_WINDOW = 0x90;
+constexpr uint8_t CMD_PARTIAL_IN = 0x91;
+constexpr uint8_t CMD_PARTIAL_OUT = 0x92;
+constexpr uint8_t CMD_CASCADE_SETTING = 0xE0;
+constexpr uint8_t CMD_FORCE_TEMPERATURE = 0xE5;
+
+// Stock driver sends the inverted buffer (set bit = white on the panel)
+inline uint8_t to_panel(uint8_t b) { return static_cast<uint8_t>(~b); }
+
+// The stock driver keeps its framebuffer, render entry point and SPI data
+// framing protected. Member pointers formed through a derived class are the
+// standard-conforming way to reach them without patching ESPHome.
+struct Access : esphome::waveshare_epaper::WaveshareEPaper {
+  using Panel = esphome::waveshare_epaper::WaveshareEPaper;
+  static uint8_t *frame(Panel *p) { return p->*(&Access::buffer_); }
+  static void render(Panel *p) { (p->*(&Access::do_update_))(); }
+  static void start_data(Panel *p) { (p->*(&Access::start_data_))(); }
+  static void end_data(Panel *p) { (p->*(&Access::end_data_))(); }
+  static esphome::GPIOPin *busy_pin(Panel *p) { return p->*(&Access::busy_pin_); }
+  static void reset(Panel *p) { (p->*(&Access::reset_))(); }
+};
+
+}  // namespace homink_panel
+
+// ============================================================================
+// GLYPH BLITTER
+// ============================================================================
+// Text and icon fast path for the rotated 1bpp panel. Font::print() sends every
+// set glyph pixel through draw_pixel_at(): clipping, the rotation transform and
+// a virtual bit read-modify-write per pixel, thousands of calls for the 96px
+// temperature and 84px weather icons alone. With rotation: 90° a glyph column
+// is one contiguous run of a native framebuffer row, so the blitter walks each
+// glyph column by column, packs the run into whole bytes and ORs (or clears)
+// them straight into the framebuffer.
+//
+// set_display() draws a probe pixel through the driver to confirm the rotation
+// mapping and bit polarity. Anything the fast path doesn't handle (another
+// rotation, an anti-aliased font, a missing glyph) goes through the driver.
+
+class GlyphBlitter {
+public:
+  using Panel = esphome::waveshare_epaper::WaveshareEPaper;
+
+  void set_display(Panel *p) {
+    _panel = p;
+    _mode = probe_();
+    ESP_LOGI("display", "Glyph blitter %s", _mode == Mode::DRIVER ? "disabled - text drawn by the driver" : "enabled");
+  }
+
+  // Drop-in for it.printf() in the display lambda
+  void printf(int x, int y, esphome::font::Font *font, esphome::Color color, esphome::display::TextAlign align,
+              const char *format, ...) __attribute__((format(printf, 7, 8))) {
+    char text[TEXT_MAX];
+    va_list args;
+    va_start(args, format);
+    int n = std::vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (n > 0) print(x, y, font, color, align, text);
+  }
+
+  void print(int x, int y, esphome::font::Font *font, esphome::Color color, esphome::display::TextAlign align,
+             const char *text) {
+    if (_mode == Mode::DRIVER || font->get_bpp() != 1 || !covered_(font, text)) {
+      _panel->print(x, y, font, color, align, text);
+      _fallbacks++;
+      return;
+    }
+
+    int x_at, y_top, width, height;
+    _panel->get_text_bounds(x, y, text, font, align, &x_at, &y_top, &width, &height);
+    bool set = color.is_on() == (_mode == Mode::ON_SETS_BITS);
+    const auto &glyphs = font->get_glyphs();
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(text);
+    while (*p) {
+      int length = 1;
+      const esphome::font::GlyphData *glyph = glyphs[font->match_next_glyph(p, &length)].get_glyph_data();
+      blit_(glyph, x_at + glyph->offset_x, y_top + glyph->offset_y, set);
+      x_at += glyph->advance;
+      p += length;
+    }
+    _blitted++;
+  }
+
+  // Strings drawn by the fast path / handed to the driver since boot
+  uint32_t blitted() const { return _blitted; }
+  uint32_t fallbacks() const { return _fallbacks; }
+
+private:
+  enum class Mode : uint8_t { DRIVER, ON_SETS_BITS, ON_CLEARS_BITS };
+
+  Mode probe_() {
+    using namespace homink_panel;
+    uint8_t *frame = Access::frame(_panel);
+    if (!frame || _panel->get_rotation() != esphome::display::DISPLAY_ROTATION_90_DEGREES) return Mode::DRIVER;
+    // Portrait (0, 0) lands on native (799, 0): bit 0 of the last byte of row 0
+    uint8_t &probe = frame[ROW_BYTES - 1];
+    uint8_t saved = probe;
+    probe = 0x00;
+    _panel->draw_pixel_at(0, 0, esphome::COLOR_ON);
+    uint8_t from_clear = probe;
+    probe = 0xFF;
+    _panel->draw_pixel_at(0, 0, esphome::COLOR_ON);
+    uint8_t from_set = probe;
+    probe = saved;
+    if (from_clear == 0x01 && from_set == 0xFF) return Mode::ON_SETS_BITS;
+    if (from_clear == 0x00 && from_set == 0xFE) return Mode::ON_CLEARS_BITS;
+    ESP_LOGW("display", "Unexpected pixel mapping (0x%02x/0x%02x)", from_clear, from_set);
+    return Mode::DRIVER;
+  }
+
+  static bool covered_(esphome::font::Font *font, const char *text) {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(text);
+    while (*p) {
+      int length = 1;
+      if (font->match_next_glyph(p, &length) < 0) return false;
+      p += length;
+    }
+    return true;
+  }
+
+  // Glyph pixel (gx, gy) is bit gy * width + gx of a row-major bitstream without
+  // row padding. Portrait (x, y) is native (799 - y, x), so glyph column gx is
+  // native row x0 + gx, and native x ascending walks the glyph rows bottom-up.
+  void blit_(const esphome::font::GlyphData *glyph, int x0, int y0, bool set) {
+    using namespace homink_panel;
+    uint8_t *frame = Access::frame(_panel);
+    const uint8_t *data = glyph->data;
+    int w = glyph->width;
+    int gy_first = std::max(0, -y0);
+    int gy_last = std::min(glyph->height, NATIVE_WIDTH - y0);  // Exclusive
+    if (gy_first >= gy_last) return;
+    int gx_first = std::max(0, -x0);
+    int gx_last = std::min(w, NATIVE_HEIGHT - x0);
+    int nx_first = NATIVE_WIDTH - y0 - gy_last;
+
+    for (int gx = gx_first; gx < gx_last; gx++) {
+      uint8_t *row = frame + (x0 + gx) * ROW_BYTES;
+      int bit = (gy_last - 1) * w + gx;
+      int nx = nx_first;
+      int byte = nx >> 3;
+      uint8_t acc = 0;
+      for (int gy = gy_last - 1; gy >= gy_first; gy--, nx++, bit -= w) {
+        if ((nx >> 3) != byte) {
+          store_(row + byte, acc, set);
+          byte = nx >> 3;
+          acc = 0;
+        }
+        if (data[bit >> 3] & (0x80 >> (bit & 7))) acc |= 0x80 >> (nx & 7);
+      }
+      store_(row + byte, acc, set);
+    }
+  }
+
+  static void store_(uint8_t *dst, uint8_t bits, bool set) {
+    if (!bits) return;
+    *dst = set ? *dst | bits : *dst & ~bits;
+  }
+
+  static constexpr size_t TEXT_MAX = 64;  // Longest formatted string (values, names, status)
+
+  Panel *_panel{nullptr};
+  Mode _mode{Mode::DRIVER};
+  uint32_t _blitted{0};
+  uint32_t _fallbacks{0};
+};
+
+GlyphBlitter eink_text;
+
+// ============================================================================
+// PARTIAL REFRESH ENGINE
+// ============================================================================
+// Renders the display lambda, diffs the framebuffer word by word against a
+// shadow copy of the last frame sent and pushes only the sections that changed
+// using the controller's partial window mode (~0.5s, no flashing). An
+// unchanged frame skips the SPI transfer and busy-wait entirely. Full
+// refreshes (~4s, flashing) are reserved for the first frame after boot and
+// explicit anti-ghosting requests.
+//
+// Refreshes are asynchronous: begin() renders and transfers the frame, then
+// poll() is called from a script wait_until until the panel drops BUSY. The
+// main loop (API, sensor callbacks, time triggers) keeps running meanwhile.
+//
+// Low-power mode powers the controller off and puts it in deep sleep at the end
+// of every refresh (poll() finishes only once it sleeps). The next transfer
+// wakes it through the reset pin and re-initializes it; the controller lost its
+// RAM, so partial refreshes first restore the "old" frame from the shadow.
+//
+// The static layer (titles, dividers, row icons, labels) is rendered once on
+// the first refresh and kept as a compact run-length image: runs of blank
+// bytes are stored as counts, everything else literally. Every later render
+// starts from that image and the lambda draws only the dynamic content (see
+// draw_static() / draw_dynamic()). The display sets auto_clear_enabled: false
+// so the driver doesn't wipe the layer before the lambda runs.
+
+class PanelRefresh {
+public:
+  using Panel = esphome::waveshare_epaper::WaveshareEPaper;
+
+  enum class Result : uint8_t { SKIPPED, PARTIAL, FULL };
+
+  PanelRefresh() {
+    for (const SectionBand &band : SECTION_BANDS) {
+      int first = homink_panel::band_first_byte(band.y_max);
+      int last = homink_panel::band_last_byte(band.y_min);
+      for (int col = first; col < last; col++) {
+        _column_sections[col] |= band.section;
+      }
+    }
+  }
+
+  // Binds the panel and allocates the frame shadow. Without PSRAM (esp32dev) the
+  // shadow takes 48KB of internal heap next to lwIP and the API, so it is skipped once
+  // that would leave less than SHADOW_HEAP_RESERVE free - refreshes then push the
+  // full-height window (diff_frame_() reports every section) instead of failing later.
+  void set_display(Panel *p) {
+    using namespace homink_panel;
+    _panel = p;
+    bool psram = homink_diag::free_psram() >= FRAME_BYTES;
+    uint32_t internal = homink_diag::free_heap();
+    if (!psram && internal < FRAME_BYTES + SHADOW_HEAP_RESERVE) {
+      ESP_LOGW("display", "Only %u bytes internal heap free - no frame shadow, every refresh pushes all sections",
+               (unsigned) internal);
+      return;
+    }
+    esphome::ExternalRAMAllocator<uint8_t> allocator(esphome::ExternalRAMAllocator<uint8_t>::ALLOW_FAILURE);
+    _last_frame = allocator.allocate(FRAME_BYTES);
+    if (!_last_frame) {
+      ESP_LOGW("display", "No memory for frame shadow - every refresh pushes all sections");
+      return;
+    }
+    ESP_LOGI("display", "Frame shadow: %u bytes in %s", (unsigned) FRAME_BYTES, psram ? "PSRAM" : "internal RAM");
+  }
+
+  // Sections whose changes alone don't justify a panel transfer (footer timestamp)
+  void set_cosmetic_sections(uint32_t sections) { _cosmetic_sections = sections; }
+
+  // Deep-sleep the controller between refreshes (battery units)
+  void set_low_power(bool enabled) { _low_power = enabled; }
+  bool is_asleep() const { return _asleep; }
+
+  // Render and start pushing. full=true forces a full refresh (anti-ghosting).
+  // required lists cosmetic sections that must be pushed this time if they changed.
+  // Returns SKIPPED without touching the panel when nothing significant changed.
+  Result begin(bool full, uint32_t required = SECTION_NONE) {
+    if (!_panel) {
+      ESP_LOGE("display", "Panel not bound - call eink_panel.set_display() on boot");
+      return _result = Result::SKIPPED;
+    }
+    if (_busy) {
+      ESP_LOGW("display", "Refresh still in progress - ignoring new refresh");
+      return _result = Result::SKIPPED;
+    }
+
+    if (!_background_built) build_background_();
+
+    uint32_t allocs_before = homink_diag::allocation_count();
+    uint32_t render_start = micros();
+    if (_background) {
+      restore_background_();
+      _layer = Layer::DYNAMIC;
+    } else {
+      _panel->clear();
+      _layer = Layer::ALL;
+    }
+    homink_panel::Access::render(_panel);
+    _render_us = micros() - render_start;
+    _render_allocations = homink_diag::allocation_count() - allocs_before;
+    if (_render_allocations) {
+      ESP_LOGW("display", "Display lambda allocated %u times", (unsigned) _render_allocations);
+    }
+    ESP_LOGD("display", "Rendered in %uus", (unsigned) _render_us);
+    uint32_t changed = diff_frame_();
+    log_diff_();
+
+    // The woken controller has no old frame to diff against without the shadow
+    bool wake_full = _asleep && !_last_frame;
+    uint32_t transfer_start = micros();
+    _transfer_us = 0;
+    _transfer_bytes = 0;
+    _busy_us = 0;
+    _follow_up = SECTION_NONE;
+    if (full || !_has_frame || wake_full) {
+      ESP_LOGD("display", "Full refresh%s", !_has_frame ? " (first frame)" : wake_full ? " (wake without shadow)" : " (anti-ghosting)");
+      wake_();
+      start_full_();
+      _transfer_us = micros() - transfer_start;
+      log_transfer_();
+      _has_frame = true;
+      _last_sections = SECTION_ALL;
+      return _result = Result::FULL;
+    }
+
+    if ((changed & ~(_cosmetic_sections & ~required)) == SECTION_NONE) {
+      ESP_LOGD("display", "No significant section changed - skipping panel transfer");
+      _last_sections = SECTION_NONE;
+      return _result = Result::SKIPPED;
+    }
+
+    _last_sections = changed;
+    bool restore_old = _asleep;
+    uint32_t window = split_cosmetic_(changed);
+    _follow_up_restore = restore_old;
+    wake_();
+    start_partial_(window, restore_old);
+    _transfer_us = micros() - transfer_start;
+    log_transfer_();
+    return _result = Result::PARTIAL;
+  }
+
+  // Non-blocking completion check - true once the panel has finished refreshing
+  bool poll() {
+    if (!_busy) return true;
+
+    uint32_t elapsed = millis() - _started_ms;
+    if (!busy_released_(elapsed)) return false;
+
+    if (_powering_off) {
+      // Power-off finished - deep sleep needs a reset to wake up
+      _panel->command(homink_panel::CMD_DEEP_SLEEP);
+      _panel->data(homink_panel::DEEP_SLEEP_CHECK_CODE);
+      _powering_off = false;
+      _asleep = true;
+      _busy = false;
+      ESP_LOGD("display", "Panel asleep");
+      return true;
+    }
+
+    _busy_us += micros() - _started_us;
+    if (_result == Result::PARTIAL) {
+      finish_partial_();
+      if (_follow_up != SECTION_NONE) {
+        ESP_LOGD("display", "Window done in %ums - refreshing cosmetic sections", (unsigned) elapsed);
+        uint32_t sections = _follow_up;
+        _follow_up = SECTION_NONE;
+        start_partial_(sections, _follow_up_restore);
+        return false;
+      }
+    }
+    ESP_LOGD("display", "Panel refresh done in %ums", (unsigned) elapsed);
+
+    if (_low_power) {
+      _panel->command(homink_panel::CMD_POWER_OFF);
+      _powering_off = true;
+      start_wait_();
+      return false;
+    }
+    _busy = false;
+    return true;
+  }
+
+  // Queried by the display lambda: static content is drawn only while the
+  // background layer is built, dynamic content only on top of it (both when
+  // no layer could be cached)
+  bool draw_static() const { return _layer != Layer::DYNAMIC; }
+  bool draw_dynamic() const { return _layer != Layer::BACKGROUND; }
+
+  bool is_busy() const { return _busy; }
+  Result last_result() const { return _result; }
+
+  // Sections pushed by the most recent refresh (SECTION_ALL for a full refresh)
+  uint32_t last_sections() const { return _last_sections; }
+
+  // Bytes / pixels that differed from the last frame sent, measured by the most recent refresh
+  uint32_t changed_bytes() const { return _changed_bytes; }
+  uint32_t changed_pixels() const { return _changed_pixels; }
+
+  // Heap allocations made by the display lambda during the most recent render (should be 0)
+  uint32_t render_allocations() const { return _render_allocations; }
+
+  // Most recent render (background restore + dynamic layer) and the one-time
+  // static layer render, in microseconds
+  uint32_t render_us() const { return _render_us; }
+  uint32_t background_render_us() const { return _background_render_us; }
+
+  // Most recent panel wake + SPI transfer (0 when skipped) and BUSY wait, in microseconds
+  uint32_t transfer_us() const { return _transfer_us; }
+  uint32_t transfer_bytes() const { return _transfer_bytes; }  // Frame data sent (old + new)
+  uint32_t busy_us() const { return _busy_us; }
+
+private:
+  enum class Layer : uint8_t { BACKGROUND, DYNAMIC, ALL };
+
+  // Render the static layer alone and keep it run-length encoded. Titles and
+  // labels are sparse, so the image is a few KB instead of another 48KB frame.
+  void build_background_() {
+    using namespace homink_panel;
+    _background_built = true;
+
+    uint32_t start = micros();
+    _panel->clear();
+    const uint8_t *frame = Access::frame(_panel);
+    _blank = frame[0];
+    _layer = Layer::BACKGROUND;
+    Access::render(_panel);
+    _background_render_us = micros() - start;
+
+    uint32_t size = encode_background_(frame, nullptr);
+    esphome::ExternalRAMAllocator<uint8_t> allocator(esphome::ExternalRAMAllocator<uint8_t>::ALLOW_FAILURE);
+    _background = allocator.allocate(size);
+    if (!_background) {
+      ESP_LOGW("display", "No memory for static layer - rendering every element each refresh");
+      return;
+    }
+    encode_background_(frame, _background);
+    _background_size = size;
+    ESP_LOGI("display", "Static layer cached: %u bytes, rendered in %uus",
+             (unsigned) size, (unsigned) _background_render_us);
+  }
+
+  // Token stream of [blank count][literal count][literal bytes...], each count
+  // 0-255. Returns the encoded size; out may be null to only measure.
+  uint32_t encode_background_(const uint8_t *frame, uint8_t *out) const {
+    using namespace homink_panel;
+    uint32_t size = 0;
+    uint32_t i = 0;
+    while (i < FRAME_BYTES) {
+      uint32_t skip = 0;
+      while (i + skip < FRAME_BYTES && skip < RUN_MAX && frame[i + skip] == _blank) skip++;
+      i += skip;
+      uint32_t literal = 0;
+      while (i + literal < FRAME_BYTES && literal < RUN_MAX && frame[i + literal] != _blank) literal++;
+      if (out) {
+        out[size] = static_cast<uint8_t>(skip);
+        out[size + 1] = static_cast<uint8_t>(literal);
+        std::memcpy(out + size + 2, frame + i, literal);
+      }
+      size += 2 + literal;
+      i += literal;
+    }
+    return size;
+  }
+
+  void restore_background_() {
+    uint8_t *frame = homink_panel::Access::frame(_panel);
+    uint32_t i = 0;
+    for (uint32_t pos = 0; pos < _background_size; ) {
+      uint8_t skip = _background[pos];
+      uint8_t literal = _background[pos + 1];
+      std::memset(frame + i, _blank, skip);
+      i += skip;
+      std::memcpy(frame + i, _background + pos + 2, literal);
+      i += literal;
+      pos += 2 + literal;
+    }
+  }
+
+  // Word-wise compare against the shadow, returning a mask of sections that differ
+  uint32_t diff_frame_() {
+    using namespace homink_panel;
+    if (!_last_frame) {
+      _changed_bytes = FRAME_BYTES;
+      _changed_pixels = FRAME_BYTES * 8;
+      return SECTION_ALL;
+    }
+
+    const uint8_t *frame = Access::frame(_panel);
+    uint32_t changed = SECTION_NONE;
+    uint32_t count = 0;
+    uint32_t pixels = 0;
+    std::memset(_column_pixels, 0, sizeof(_column_pixels));
+    _changed_row_min = NATIVE_HEIGHT;
+    _changed_row_max = -1;
+    // ROW_BYTES is a multiple of 4, so a word never straddles two rows
+    for (uint32_t i = 0; i < FRAME_BYTES; i += 4) {
+      uint32_t cur, prev;
+      std::memcpy(&cur, frame + i, 4);
+      std::memcpy(&prev, _last_frame + i, 4);
+      if (cur == prev) continue;
+      int row = i / ROW_BYTES;
+      _changed_row_min = std::min(_changed_row_min, row);
+      _changed_row_max = std::max(_changed_row_max, row);
+      for (uint32_t b = i; b < i + 4; b++) {
+        if (frame[b] != _last_frame[b]) {
+          int col = b % ROW_BYTES;
+          uint32_t bits = __builtin_popcount(frame[b] ^ _last_frame[b]);
+          count++;
+          pixels += bits;
+          _column_pixels[col] += bits;
+          changed |= _column_sections[col];
+        }
+      }
+    }
+    _changed_bytes = count;
+    _changed_pixels = pixels;
+    return changed;
+  }
+
+  // Changed pixels and their portrait bounding box (native rows are portrait X,
+  // native columns run against portrait Y) - the data for sizing section bands
+  void log_diff_() {
+    using namespace homink_panel;
+    if (!_last_frame || !_changed_pixels) {
+      ESP_LOGD("display", "Frame diff: %u bytes changed", (unsigned) _changed_bytes);
+      return;
+    }
+    int first = 0;
+    while (!_column_pixels[first]) first++;
+    int last = ROW_BYTES;
+    while (!_column_pixels[last - 1]) last--;
+    ESP_LOGD("display", "Frame diff: %u bytes, %u pixels changed in portrait X %d-%d, Y %d-%d",
+             (unsigned) _changed_bytes, (unsigned) _changed_pixels, _changed_row_min, _changed_row_max,
+             NATIVE_WIDTH - last * 8, NATIVE_WIDTH - first * 8 - 1);
+  }
+
+  // Changed pixels in the byte columns a section band covers
+  uint32_t section_pixels_(const SectionBand &band) const {
+    uint32_t pixels = 0;
+    for (int col = homink_panel::band_first_byte(band.y_max); col < homink_panel::band_last_byte(band.y_min); col++) {
+      pixels += _column_pixels[col];
+    }
+    return pixels;
+  }
+
+  // Record what the panel now shows for native byte columns [first, last)
+  void save_columns_(int first, int last) {
+    using namespace homink_panel;
+    if (!_last_frame) return;
+    const uint8_t *frame = Access::frame(_panel);
+    for (int row = 0; row < NATIVE_HEIGHT; row++) {
+      std::memcpy(_last_frame + row * ROW_BYTES + first, frame + row * ROW_BYTES + first, last - first);
+    }
+  }
+
+  // Same sequence as the stock 7.50inv2 driver, minus its blocking waits. The
+  // frame also goes to OLD RAM: the full-refresh setting (VCOM 0x10) doesn't copy
+  // new to old, and the next partial waveform diffs its window against OLD.
+  void start_full_() {
+    using namespace homink_panel;
+    _panel->command(CMD_DATA_START_OLD);
+    stream_columns_(Access::frame(_panel), 0, ROW_BYTES);
+    _panel->command(CMD_DATA_START_NEW);
+    send_columns_(0, ROW_BYTES);
+    _panel->command(CMD_DISPLAY_REFRESH);
+    start_wait_();
+  }
+
+  // Portrait rows [y_min, y_max) spanned by the bands in sections
+  static void section_span_(uint32_t sections, int &y_min, int &y_max) {
+    y_min = homink_layout::DISPLAY_HEIGHT;
+    y_max = 0;
+    for (const SectionBand &band : SECTION_BANDS) {
+      if (!(sections & band.section)) continue;
+      y_min = std::min(y_min, band.y_min);
+      y_max = std::max(y_max, band.y_max);
+    }
+  }
+
+  // The footer timestamp changes on every refresh. Merged into the bounding window,
+  // it would stretch a weather change into a near full-height partial, so cosmetic
+  // sections further than WINDOW_MERGE_GAP_PX from the rest get their own follow-up
+  // window (_follow_up, started by poll()). Returns the sections of the first window.
+  uint32_t split_cosmetic_(uint32_t changed) {
+    uint32_t cosmetic = changed & _cosmetic_sections;
+    uint32_t main = changed & ~_cosmetic_sections;
+    if (!cosmetic || !main) return changed;
+    int main_min, main_max, cosmetic_min, cosmetic_max;
+    section_span_(main, main_min, main_max);
+    section_span_(cosmetic, cosmetic_min, cosmetic_max);
+    int gap = std::max(cosmetic_min - main_max, main_min - cosmetic_max);
+    if (gap <= WINDOW_MERGE_GAP_PX) return changed;
+    _follow_up = cosmetic;
+    return main;
+  }
+
+  // One partial window spanning every changed section (apart from a distant footer,
+  // see split_cosmetic_()). On this controller each window needs its own refresh
+  // cycle, so a single bounding window is faster than refreshing disjoint sections
+  // one after another.
+  void start_partial_(uint32_t changed, bool restore_old) {
+    for (const SectionBand &band : SECTION_BANDS) {
+      if (!(changed & band.section)) continue;
+      ESP_LOGD("display", "Section changed: %s (%u pixels)", band.name, (unsigned) section_pixels_(band));
+    }
+    int y_min, y_max;
+    section_span_(changed, y_min, y_max);
+
+    int first = homink_panel::band_first_byte(y_max);
+    int last = homink_panel::band_last_byte(y_min);
+    ESP_LOGD("display", "Partial refresh: portrait Y %d-%d (%d bytes)",
+             y_min, y_max, (last - first) * homink_panel::NATIVE_HEIGHT);
+
+    using namespace homink_panel;
+    _panel->command(CMD_CASCADE_SETTING);    // Use forced temperature...
+    _panel->data(0x02);
+    _panel->command(CMD_FORCE_TEMPERATURE);  // ...that selects the fast partial waveform
+    _panel->data(0x6E);
+    _panel->command(CMD_VCOM_DATA_INTERVAL); // Copy new data to old after refresh
+    _panel->data(0xA9);
+    _panel->data(0x07);
+
+    _panel->command(CMD_PARTIAL_IN);
+    _panel->command(CMD_PARTIAL_WINDOW);
+    send_u16_(first * 8);
+    send_u16_(last * 8 - 1);
+    send_u16_(0);
+    send_u16_(NATIVE_HEIGHT - 1);
+    _panel->data(0x01);  // Scan inside window only
+
+    if (restore_old) {
+      // Controller RAM was lost in deep sleep - reload what the panel shows
+      _panel->command(CMD_DATA_START_OLD);
+      stream_columns_(_last_frame, first, last);
+    }
+    _panel->command(CMD_DATA_START_NEW);
+    send_columns_(first, last);
+    _panel->command(CMD_DISPLAY_REFRESH);
+    start_wait_();
+  }
+
+  // BUSY reads high while the controller works (inverted pin)
+  bool busy_released_(uint32_t elapsed) {
+    if (elapsed < BUSY_ASSERT_DELAY_MS) return false;  // BUSY may not be asserted yet
+
+    esphome::GPIOPin *busy = homink_panel::Access::busy_pin(_panel);
+    if (busy && busy->digital_read()) {
+      if (elapsed < REFRESH_TIMEOUT_MS) return false;
+      ESP_LOGE("display", "Timeout waiting for panel BUSY after %ums", (unsigned) elapsed);
+    } else if (!busy && elapsed < NO_BUSY_PIN_WAIT_MS) {
+      return false;
+    }
+    return true;
+  }
+
+  // Hardware reset + init sequence (same as ESPHome setup). The driver's
+  // init briefly blocks on BUSY while the charge pump powers on.
+  void wake_() {
+    if (!_asleep) return;
+    ESP_LOGD("display", "Waking panel");
+    homink_panel::Access::reset(_panel);
+    _panel->initialize();
+    _asleep = false;
+  }
+
+  void finish_partial_() {
+    using namespace homink_panel;
+    _panel->command(CMD_PARTIAL_OUT);
+
+    // Restore full-refresh settings for the next full refresh
+    _panel->command(CMD_CASCADE_SETTING);
+    _panel->data(0x00);
+    _panel->command(CMD_VCOM_DATA_INTERVAL);
+    _panel->data(0x10);
+    _panel->data(0x07);
+  }
+
+  // Bus throughput of the most recent transfer (includes the panel wake when asleep)
+  void log_transfer_() const {
+    ESP_LOGD("display", "Transferred %u bytes in %uus (%.2f MB/s)", (unsigned) _transfer_bytes,
+             (unsigned) _transfer_us, _transfer_us ? float(_transfer_bytes) / _transfer_us : 0.0f);
+  }
+
+  // Stream native byte columns [first, last) of every row, then record them as
+  // shown. The controller holds the frame from here on, so the framebuffer is
+  // free to be rendered again while the panel is still busy.
+  void send_columns_(int first, int last) {
+    stream_columns_(homink_panel::Access::frame(_panel), first, last);
+    save_columns_(first, last);
+  }
+
+  // Rows are inverted into _chunk and sent TRANSFER_CHUNK bytes per write_array:
+  // a full frame is 24 bus transactions instead of 480 row writes.
+  void stream_columns_(const uint8_t *frame, int first, int last) {
+    using namespace homink_panel;
+    uint32_t width = last - first;
+    uint32_t fill = 0;
+    Access::start_data(_panel);
+    for (int row = 0; row < NATIVE_HEIGHT; row++) {
+      const uint8_t *src = frame + row * ROW_BYTES + first;
+      for (uint32_t col = 0; col < width; col++) {
+        _chunk[fill++] = to_panel(src[col]);
+      }
+      if (fill + width > TRANSFER_CHUNK) {
+        _panel->write_array(_chunk, fill);
+        fill = 0;
+      }
+    }
+    if (fill) _panel->write_array(_chunk, fill);
+    Access::end_data(_panel);
+    _transfer_bytes += width * NATIVE_HEIGHT;
+  }
+
+  void start_wait_() {
+    _busy = true;
+    _started_ms = millis();
+    _started_us = micros();
+  }
+
+  void send_u16_(int v) {
+    _panel->data(static_cast<uint8_t>(v >> 8));
+    _panel->data(static_cast<uint8_t>(v & 0xFF));
+  }
+
+  static constexpr uint32_t BUSY_ASSERT_DELAY_MS = 10;    // BUSY goes low shortly after refresh command
+  static constexpr uint32_t REFRESH_TIMEOUT_MS = 10000;   // Full refresh takes ~4s
+  static constexpr uint32_t NO_BUSY_PIN_WAIT_MS = 5000;   // Fixed wait if no BUSY pin is configured
+  static constexpr uint32_t SHADOW_HEAP_RESERVE = 32768;  // Internal heap kept free for lwIP/API after the shadow
+  static constexpr uint32_t RUN_MAX = 255;                // Longest run per static layer token
+  static constexpr int WINDOW_MERGE_GAP_PX = 100;        // Cosmetic sections closer than this share the window
+  static constexpr uint32_t TRANSFER_CHUNK = 20 * homink_panel::ROW_BYTES;  // Bytes per SPI write (20 full rows)
+
+  Panel *_panel{nullptr};
+  uint8_t *_last_frame{nullptr};  // What the panel currently shows (FRAME_BYTES)
+  uint8_t *_background{nullptr};  // Run-length encoded static layer
+  uint32_t _background_size{0};
+  bool _background_built{false};
+  uint8_t _blank{0xFF};           // Framebuffer byte value after clear()
+  Layer _layer{Layer::ALL};
+  bool _has_frame{false};
+  bool _busy{false};
+  bool _low_power{false};
+  bool _powering_off{false};
+  bool _asleep{false};
+  uint32_t _started_ms{0};
+  uint32_t _started_us{0};
+  Result _result{Result::SKIPPED};
+  uint32_t _cosmetic_sections{SECTION_NONE};
+  uint32_t _follow_up{SECTION_NONE};  // Cosmetic sections left for a second window
+  bool _follow_up_restore{false};     // Second window also reloads OLD RAM (woke from deep sleep)
+  uint32_t _last_sections{SECTION_NONE};
+  uint32_t _changed_bytes{0};
+  uint32_t _changed_pixels{0};
+  int _changed_row_min{0};
+  int _changed_row_max{-1};
+  uint32_t _column_pixels[homink_panel::ROW_BYTES]{};    // Changed pixels per native byte column (last diff)
+  uint32_t _render_allocations{0};
+  uint32_t _render_us{0};
+  uint32_t _background_render_us{0};
+  uint32_t _transfer_us{0};
+  uint32_t _transfer_bytes{0};
+  uint32_t _busy_us{0};
+  uint8_t _chunk[TRANSFER_CHUNK];  // Inverted rows waiting for the next SPI write
+  uint32_t _column_sections[homink_panel::ROW_BYTES]{};  // Sections overlapping each native byte column
+};
+
+PanelRefresh eink_panel;
@@ -1,143 +1,296 @@
 #pragma once
 
 #include "esphome.h"
+#include "homink_diag.h"
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <type_traits>
 #include <cstring>
+#include <cstdio>
+
+// Per-push change-detection log lines (printf formatting on every callback). Build with
+// -DHOMINK_VERBOSE_SENSOR_LOG=0 (verbose_sensor_log substitution) to compile them out;
+// homink_diag::trace keeps the same decisions in binary form.
+#ifndef HOMINK_VERBOSE_SENSOR_LOG
+#define HOMINK_VERBOSE_SENSOR_LOG 1
+#endif
+#if HOMINK_VERBOSE_SENSOR_LOG
+#define SENSOR_LOGD(...) ESP_LOGD("main", __VA_ARGS__)
+#define SENSOR_LOGV(...) ESP_LOGV("main", __VA_ARGS__)
+#else
+#define SENSOR_LOGD(...) do {} while (0)
+#define SENSOR_LOGV(...) do {} while (0)
+#endif
 
 // ============================================================================
 // SENSOR STATE SYSTEM
 // ============================================================================
-// Unified linked list containing all sensors regardless of type.
-// Enables generic iteration via ISensor::update_all() and check_all_for_changes().
+// Every sensor is listed once in the device SENSOR_LIST() X-macro. SENSOR_REGISTRY()
+// expands it into the sensor variables and a compile-time registry (Sensors), so
+// update_all() and the HA request helpers are straight-line calls on concrete types:
+// no linked list, no vtables (BaseSensor uses CRTP for the per-type hooks). Per-push and
+// per-tick checks (dirty, barriers, last push) are O(1) counters, so a list of 100+
+// entities costs each callback the same as a dozen.
 
-// ISensor - Base class for linked list infrastructure
-class ISensor {
+// SensorCore - Non-template state shared by all sensors (push tracking, staleness, HA request barrier)
+class SensorCore {
 public:
-  virtual ~ISensor() = default;
+  // Seconds without a push before the poller re-requests this entity (0 = default budget)
+  void set_stale_after(uint32_t seconds) { _stale_after_ms = seconds * 1000; }
+  static void set_default_stale_after(uint32_t seconds) { _default_stale_after_ms = seconds * 1000; }
 
-  // Pure virtual methods implemented by templated base class
-  virtual void update() = 0;
-  virtual bool should_trigger_update() = 0;
-  virtual const char *name() const = 0;
-  virtual const char *entity_id() const = 0;
-  virtual void log_change(const char *reason) const = 0;
-  virtual bool is_initialized() const = 0;
+  bool is_stale(uint32_t now_ms, uint32_t min_budget_ms = 0) const {
+    uint32_t budget = _stale_after_ms ? _stale_after_ms : _default_stale_after_ms;
+    return !_has_pushed || now_ms - _last_push_ms >= std::max(budget, min_budget_ms);
+  }
 
-  // Static methods - iterate all sensors in unified list
-  static void update_all() {
-    for (ISensor *sensor = _list_head; sensor; sensor = sensor->_next) {
-      sensor->update();
-    }
+  // Showing a warm-boot cache value - no live push since boot yet (is_stale() holds too)
+  bool is_restored() const { return _restored; }
+
+  // HA request barrier bookkeeping (driven by SensorRegistry::begin_ha_request()). The
+  // outstanding count follows every push, so the barrier check doesn't scan the list.
+  void set_requested(bool requested) {
+    if (is_request_pending()) _requests_outstanding--;
+    _requested = requested;
+    _updated_since_request = false;
+    if (requested) _requests_outstanding++;
   }
+  bool is_requested() const { return _requested; }
+  bool is_request_pending() const { return _requested && !_updated_since_request; }
 
-  static bool check_all_for_changes() {
-    for (ISensor *sensor = _list_head; sensor; sensor = sensor->_next) {
-      if (sensor->should_trigger_update()) {
-        sensor->log_change("change detected - triggering update");
-        return true;
-      }
-    }
-    return false;
+  // Count the current request as answered - by a push, or up front for a value fresh
+  // enough that HA has nothing new to send (it doesn't re-send unchanged states)
+  void answer_request() {
+    if (is_request_pending()) _requests_outstanding--;
+    _updated_since_request = true;
   }
+  static uint16_t requests_outstanding() { return _requests_outstanding; }
 
-  // Generate comma-separated list of HA entity_ids (excludes ESPHome built-ins)
-  // Cached after first call since sensor list doesn't change at runtime
-  static std::string get_ha_entity_list() {
-    static std::string cached_list;
-    if (cached_list.empty()) {
-      for (ISensor *sensor = _list_head; sensor; sensor = sensor->_next) {
-        const char *entity = sensor->entity_id();
-        if (std::strchr(entity, '.') != nullptr) {  // Has '.' = HA entity
-          if (!cached_list.empty()) {
-            cached_list += ",";
-          }
-          cached_list += entity;
-        }
-      }
-      ESP_LOGD("sensor", "Cached HA entity list: %s", cached_list.c_str());
-    }
-    return cached_list;
+  // Sync window bookkeeping (SensorRegistry::begin_sync()), counted the same way
+  void set_sync_waiting(bool waiting) {
+    if (_sync_waiting) _sync_outstanding--;
+    _sync_waiting = waiting;
+    if (waiting) _sync_outstanding++;
   }
+  static uint16_t sync_outstanding() { return _sync_outstanding; }
 
-  // Validate all sensors are properly initialized (call after SENSOR_INIT_ALL)
-  // Returns true if all sensors are valid, false if any are missing
-  static bool validate_all() {
-    bool all_valid = true;
-    int count = 0;
-    for (ISensor *sensor = _list_head; sensor; sensor = sensor->_next) {
-      count++;
-      if (!sensor->is_initialized()) {
-        ESP_LOGE("sensor", "SENSOR NOT INITIALIZED: %s (%s) - check YAML id matches C++ variable",
-                 sensor->name(), sensor->entity_id());
-        all_valid = false;
-      }
-    }
-    if (all_valid) {
-      ESP_LOGI("sensor", "All %d sensors initialized successfully", count);
-    } else {
-      ESP_LOGE("sensor", "Sensor initialization failed - display may not update correctly");
-    }
-    return all_valid;
+  // Dirty flag (SensorRegistry::mark_dirty() / take_dirty()): set by a significant change,
+  // skips further change checks until the next refresh takes it
+  bool is_dirty() const { return _dirty; }
+  bool was_dirty() const { return _was_dirty; }  // Taken by the last refresh
+  bool set_dirty_flag() {
+    if (_dirty) return false;
+    _dirty = true;
+    return true;
   }
+  bool take_dirty_flag() {
+    _was_dirty = _dirty;
+    _dirty = false;
+    return _was_dirty;
+  }
+
+  // SENSOR_LIST position and the display sections this sensor is drawn in
+  void set_slot(uint16_t slot) { _slot = slot; }
+  uint16_t slot() const { return _slot; }
+  void set_sections(uint32_t sections) { _sections = sections; }
+  uint32_t sections() const { return _sections; }
+
+  // Live stream statistics since boot: HA pushes received, and how many of them
+  // SENSOR_UPDATE_CALLBACK found significant (the refreshes this sensor's threshold allows)
+  void record_trigger() { _triggers++; }
+  uint32_t pushes() const { return _pushes; }
+  uint32_t triggers() const { return _triggers; }
+
+  // Push health for the adaptive poll (SensorRegistry::ms_since_last_push())
+  bool has_pushed() const { return _has_pushed; }
+  uint32_t last_push_ms() const { return _last_push_ms; }
+  static bool any_pushed() { return _any_pushed; }
+  static uint32_t newest_push_ms() { return _newest_push_ms; }
+
+  // Last change check rejected the push as a filtered transition (trace decision IGNORED)
+  bool was_ignored() const { return _ignored; }
 
 protected:
-  ISensor() : _next(nullptr) {
-    if (!_list_head) {
-      _list_head = this;
-    } else {
-      ISensor *tail = _list_head;
-      while (tail->_next) {
-        tail = tail->_next;
-      }
-      tail->_next = this;
-    }
+  SensorCore()
+    : _updated_since_request(false), _requested(false), _has_pushed(false),
+      _last_push_ms(0), _stale_after_ms(0), _sections(0),
+      _pushes(0), _triggers(0) {}
+
+  // HA pushed a value (answers any pending update_entity request, replaces a restored one)
+  void record_push() {
+    _restored = false;
+    answer_request();
+    set_sync_waiting(false);
+    _last_push_ms = millis();
+    _has_pushed = true;
+    _pushes++;
+    _newest_push_ms = _last_push_ms;
+    _any_pushed = true;
   }
 
+  void set_ignored(bool ignored) { _ignored = ignored; }
+  void set_restored() { _restored = true; }
+
 private:
-  ISensor *_next;
-  static ISensor *_list_head;
+  bool _updated_since_request;
+  bool _requested;
+  bool _has_pushed;
+  bool _ignored{false};
+  bool _sync_waiting{false};
+  bool _dirty{false};
+  bool _was_dirty{false};
+  bool _restored{false};
+  uint16_t _slot{0};
+  uint32_t _last_push_ms;
+  uint32_t _stale_after_ms;
+  uint32_t _sections;
+  uint32_t _pushes;
+  uint32_t _triggers;
+  static uint32_t _default_stale_after_ms;
+  static uint16_t _requests_outstanding;
+  static uint16_t _sync_outstanding;
+  static bool _any_pushed;
+  static uint32_t _newest_push_ms;
 };
 
-ISensor *ISensor::_list_head = nullptr;
+uint32_t SensorCore::_default_stale_after_ms = 60000;
+uint16_t SensorCore::_requests_outstanding = 0;
+uint16_t SensorCore::_sync_outstanding = 0;
+bool SensorCore::_any_pushed = false;
+uint32_t SensorCore::_newest_push_ms = 0;
+
+// FNV-1a over a string and its terminator (so "ab","c" and "a","bc" differ) - warm-boot cache key
+inline uint32_t fnv1a(uint32_t hash, const char *text) {
+  do {
+    hash = (hash ^ uint8_t(*text)) * 16777619u;
+  } while (*text++);
+  return hash;
+}
+
+// Snapshot fan-out (see SnapshotSensor): write one decoded field into the ESPHome
+// sensor component, which runs its on_value -> SENSOR_UPDATE_CALLBACK as for a push
+enum class SnapshotField : uint8_t { UNCHANGED, PUBLISHED, INVALID };
+
+// ESPHome built-ins (WiFi signal) have no HA state to take from a snapshot
+template<typename SensorType>
+SnapshotField snapshot_publish(SensorType *, const char *, size_t) { return SnapshotField::INVALID; }
+
+inline SnapshotField snapshot_publish(esphome::homeassistant::HomeassistantSensor *s, const char *text, size_t len) {
+  char buf[24];
+  if (len == 0 || len >= sizeof(buf)) return SnapshotField::INVALID;
+  std::memcpy(buf, text, len);
+  buf[len] = '\0';
+  char *end;
+  float value = std::strtof(buf, &end);
+  if (end != buf + len) return SnapshotField::INVALID;  // Partial parse ("12abc", "1.5 kW")
+  if (s->has_state() && s->state == value) return SnapshotField::UNCHANGED;
+  s->publish_state(value);
+  return SnapshotField::PUBLISHED;
+}
+
+inline SnapshotField snapshot_publish(esphome::homeassistant::HomeassistantBinarySensor *s, const char *text, size_t len) {
+  bool on = len == 2 && std::memcmp(text, "on", 2) == 0;
+  if (!on && !(len == 3 && std::memcmp(text, "off", 3) == 0)) return SnapshotField::INVALID;
+  if (s->has_state() && s->state == on) return SnapshotField::UNCHANGED;
+  s->publish_state(on);
+  return SnapshotField::PUBLISHED;
+}
+
+inline SnapshotField snapshot_publish(esphome::homeassistant::HomeassistantTextSensor *s, const char *text, size_t len) {
+  if (len == 0) return SnapshotField::INVALID;
+  if (s->has_state() && s->state.size() == len && std::memcmp(s->state.data(), text, len) == 0) {
+    return SnapshotField::UNCHANGED;
+  }
+  static std::string scratch;  // Reused - keeps its capacity, so no allocation once warmed up
+  scratch.assign(text, len);
+  s->publish_state(scratch);
+  return SnapshotField::PUBLISHED;
+}
 
 // BaseSensor - Templated sensor base class with common logic
-template<typename ValueType, typename SensorType>
-class BaseSensor : public ISensor {
+// Derived is the concrete sensor class (CRTP); it provides is_value_change_significant()
+// and may hide decode_state()/update_value_from_sensor().
+template<typename Derived, typename ValueType, typename SensorType>
+class BaseSensor : public SensorCore {
 public:
   BaseSensor(const char *n, const char *entity, ValueType initial_val = ValueType())
-    : ISensor(), _name(n), _entity_id(entity), _has_state(false),
+    : SensorCore(), _name(n), _entity_id(entity), _has_state(false),
       _value(initial_val), _sensor(nullptr) {}
 
-  virtual ~BaseSensor() = default;
+  const char *name() const { return _name; }
+  const char *entity_id() const { return _entity_id; }
 
-  const char *name() const override { return _name; }
-  const char *entity_id() const override { return _entity_id; }
+  // HA entities have a domain prefix; ESPHome built-ins (wifisignal) don't
+  bool is_ha_entity() const { return std::strchr(_entity_id, '.') != nullptr; }
 
   bool has_state() const { return _has_state; }
   const ValueType& value() const { return _value; }
-  bool is_initialized() const override { return _sensor != nullptr; }
 
   void set_sensor(SensorType *s) { _sensor = s; }
 
-  void log_change(const char *reason) const override {
-    ESP_LOGD("main", "%s: %s", _name, reason);
+  // Trace values (homink_diag::trace): the cached value and the pushed one (EnumTextSensor:
+  // decoded) as floats - booleans 0/1, enums their index, strings NAN
+  float trace_value() const { return to_trace_(_value); }
+  float trace_state() const { return _sensor ? derived().trace_current() : NAN; }
+
+  // Snapshot field for this sensor. A changed value is published through the component
+  // (its callback records the push); an unchanged one still answers the HA request.
+  SnapshotField apply_snapshot(const char *text, size_t len) {
+    if (!_sensor) return SnapshotField::INVALID;
+    SnapshotField result = snapshot_publish(_sensor, text, len);
+    if (result == SnapshotField::UNCHANGED) record_push();
+    return result;
   }
 
-  void update() override {
-    if (!_sensor) return;
-    _has_state = _sensor && _sensor->has_state();
+  // Warm-boot cache cell (see SensorRegistry::save_warm_cache): the cached value packed
+  // into 4 bytes. Values that don't fit (strings) aren't cached, nor device-local ones
+  // (WiFi signal) - those are measured again within seconds of boot.
+  bool warm_encode(uint32_t &cell) const {
+    if constexpr (std::is_trivially_copyable<ValueType>::value && sizeof(ValueType) <= sizeof(uint32_t)) {
+      if (!_has_state || !is_ha_entity()) return false;
+      cell = 0;
+      std::memcpy(&cell, &_value, sizeof(ValueType));
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  void warm_restore(uint32_t cell) {
+    if constexpr (std::is_trivially_copyable<ValueType>::value && sizeof(ValueType) <= sizeof(uint32_t)) {
+      std::memcpy(&_value, &cell, sizeof(ValueType));
+      _has_state = true;
+      set_restored();
+    }
+  }
+
+  // Meaning of the cached bytes beyond the entity id (EnumTextSensor: its vocabulary),
+  // folded into the warm-boot cache key
+  void warm_hash(uint32_t &hash) const { derived().hash_encoding(hash); }
+
+  // Called from SENSOR_UPDATE_CALLBACK
+  void mark_updated() {
+    record_push();
+    derived().decode_state();
+  }
+
+  void update() {
+    if (!_sensor || is_restored()) return;  // Keep the warm-boot value until HA pushes
+    _has_state = _sensor->has_state();
     if (_has_state) {
-      update_value_from_sensor();
+      derived().update_value_from_sensor();
     }
   }
 
   // Check for changes - base class checks availability, derived class checks value
-  bool should_trigger_update() override {
+  bool should_trigger_update() {
     if (!_sensor) return false;
+    set_ignored(false);
 
     bool current_has_state = _sensor->has_state();
     if (current_has_state != _has_state) {
-      ESP_LOGD("main", "%s: Availability changed (%s -> %s)",
+      SENSOR_LOGD("%s: Availability changed (%s -> %s)",
                _name,
                _has_state ? "available" : "unavailable",
                current_has_state ? "available" : "unavailable");
@@ -146,20 +299,39 @@ public:
 
     if (!current_has_state) return false;
 
-    return is_value_change_significant();
+    return derived().is_value_change_significant();
   }
 
 protected:
-  void update_value_from_sensor() {
-    _value = _sensor->state;
+  // Parse the raw state pushed by HA once, at callback time (see EnumTextSensor)
+  void decode_state() {}
+
+  void hash_encoding(uint32_t &) const {}
+
+  // Pushed value for the trace (EnumTextSensor reports its decoded enum instead)
+  float trace_current() const { return to_trace_(_sensor->state); }
+
+  template<typename T> static float to_trace_(const T &v) {
+    if constexpr (std::is_arithmetic<T>::value || std::is_enum<T>::value) {
+      return static_cast<float>(v);
+    } else {
+      return NAN;
+    }
   }
 
-  virtual bool is_value_change_significant() = 0;
+  void update_value_from_sensor() {
+    if (!(_value == _sensor->state)) {
+      _value = _sensor->state;  // Strings reuse their capacity - no allocation once warmed up
+    }
+  }
 
   SensorType *_get_sensor() { return _sensor; }
   ValueType& _get_value() { return _value; }
 
 private:
+  Derived &derived() { return static_cast<Derived &>(*this); }
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
   const char *_name;
   const char *_entity_id;
   bool _has_state;
@@ -169,13 +341,16 @@ private:
 
 // StateSensor - Any value change triggers update
 template<typename ValueType, typename SensorType>
-class StateSensor : public BaseSensor<ValueType, SensorType> {
+class StateSensor : public BaseSensor<StateSensor<ValueType, SensorType>, ValueType, SensorType> {
+  using Base = BaseSensor<StateSensor, ValueType, SensorType>;
+  friend Base;
+
 public:
   StateSensor(const char *n, const char *entity, ValueType initial_val = ValueType())
-    : BaseSensor<ValueType, SensorType>(n, entity, initial_val) {}
+    : Base(n, entity, initial_val) {}
 
 protected:
-  bool is_value_change_significant() override {
+  bool is_value_change_significant() {
     return this->_get_sensor()->state != this->_get_value();
   }
 };
@@ -184,26 +359,72 @@ protected:
 using BinaryStateSensor = StateSensor<bool, esphome::homeassistant::HomeassistantBinarySensor>;
 using TextStateSensor = StateSensor<std::string, esphome::homeassistant::HomeassistantTextSensor>;
 
+// DisplayQuantizer - How a numeric sensor is rendered, so change detection can
+// compare what the display would show instead of raw values. The lambda's
+// expression is mirrored - (max(raw, floor) * scale) / divisor: float product, double
+// division, stored back into a float - and printed with its format string, so rounding
+// at .5 / .x5 matches printf exactly. Raw values at or below idle render a placeholder instead.
+// format nullptr = not configured (compare raw values against the threshold).
+struct DisplayQuantizer {
+  const char *format{nullptr};
+  float scale{1.0f};
+  double divisor{1.0};
+  float floor{-INFINITY};
+  float idle{-INFINITY};
+
+  bool enabled() const { return format != nullptr; }
+
+  // Same pixels for both values (stack buffers - no allocation on the push path)
+  bool same_text(float a, float b) const {
+    bool a_idle = a <= idle, b_idle = b <= idle;
+    if (a_idle || b_idle) return a_idle == b_idle;
+    char text_a[24], text_b[24];
+    print_(text_a, sizeof(text_a), a);
+    print_(text_b, sizeof(text_b), b);
+    return std::strcmp(text_a, text_b) == 0;
+  }
+
+private:
+  void print_(char *buf, size_t size, float raw) const {
+    float shown = (std::max(raw, floor) * scale) / divisor;  // Stored as float, like the lambda's locals
+    std::snprintf(buf, size, format, shown);
+  }
+};
+
 // ThresholdSensor - Only triggers when change exceeds threshold
 template<typename ValueType, typename SensorType>
-class ThresholdSensor : public BaseSensor<ValueType, SensorType> {
+class ThresholdSensor : public BaseSensor<ThresholdSensor<ValueType, SensorType>, ValueType, SensorType> {
+  using Base = BaseSensor<ThresholdSensor, ValueType, SensorType>;
+  friend Base;
+
 public:
   ThresholdSensor(const char *n, const char *entity, ValueType t)
-    : BaseSensor<ValueType, SensorType>(n, entity, std::numeric_limits<ValueType>::max()),
+    : Base(n, entity, std::numeric_limits<ValueType>::max()),
       _threshold(t) {}
 
+  // Trigger exactly when the rendered value changes (replaces the threshold)
+  void set_quantizer(const DisplayQuantizer &q) { _quantizer = q; }
+  const DisplayQuantizer &quantizer() const { return _quantizer; }
+
 protected:
-  bool is_value_change_significant() override {
+  bool is_value_change_significant() {
     ValueType current = this->_get_sensor()->state;
 
     if (this->_get_value() == std::numeric_limits<ValueType>::max()) {
       this->_get_value() = current;
-      ESP_LOGD("main", "%s: Initialized with first value - triggering update", this->name());
+      SENSOR_LOGD("%s: Initialized with first value - triggering update", this->name());
+      return true;
+    }
+
+    if (_quantizer.enabled()) {
+      if (_quantizer.same_text(current, this->_get_value())) return false;
+      SENSOR_LOGD("%s: Displayed value changed - triggering update", this->name());
+      this->_get_value() = current;
       return true;
     }
 
     if (std::abs(current - this->_get_value()) > _threshold) {
-      ESP_LOGD("main", "%s: Threshold exceeded - triggering update", this->name());
+      SENSOR_LOGD("%s: Threshold exceeded - triggering update", this->name());
       this->_get_value() = current;
       return true;
     }
@@ -213,19 +434,149 @@ protected:
 
 private:
   ValueType _threshold;
+  DisplayQuantizer _quantizer;
 };
 
 using FloatThresholdSensor = ThresholdSensor<float, esphome::homeassistant::HomeassistantSensor>;
 
+// ============================================================================
+// SMOOTHED THRESHOLD SENSORS
+// ============================================================================
+// For noisy values (solar under passing clouds, charging power ramps) that
+// would otherwise oscillate across a fixed threshold. Every push feeds a
+// filter; the filtered value is what gets compared and displayed. A change is
+// significant when it leaves the band around the displayed value - separate
+// widths above (rise) and below (fall) - and at least hold_ms passed since
+// this sensor last triggered. A held-back change is re-checked on the next push.
+
+// Exponential moving average - alpha 1.0 = no smoothing
+class EmaFilter {
+public:
+  explicit EmaFilter(float alpha) : _alpha(alpha) {}
+  float push(float x) {
+    _value = _primed ? _value + _alpha * (x - _value) : x;
+    _primed = true;
+    return _value;
+  }
+  bool primed() const { return _primed; }
+  float value() const { return _value; }
+
+private:
+  float _alpha;
+  float _value{0.0f};
+  bool _primed{false};
+};
+
+// Running median of the last N pushes - drops single-sample spikes entirely
+template<uint8_t N>
+class MedianFilter {
+  static_assert(N >= 1 && N <= 15, "Median window must be 1-15 samples");
+
+public:
+  float push(float x) {
+    _samples[_next] = x;
+    _next = (_next + 1) % N;
+    if (_count < N) _count++;
+    float sorted[N];
+    for (uint8_t i = 0; i < _count; i++) {  // Insertion sort - at most 15 samples
+      uint8_t j = i;
+      for (; j > 0 && sorted[j - 1] > _samples[i]; j--) sorted[j] = sorted[j - 1];
+      sorted[j] = _samples[i];
+    }
+    _value = _count % 2 ? sorted[_count / 2] : (sorted[_count / 2 - 1] + sorted[_count / 2]) / 2.0f;
+    return _value;
+  }
+  bool primed() const { return _count > 0; }
+  float value() const { return _value; }
+
+private:
+  float _samples[N]{};
+  float _value{0.0f};
+  uint8_t _next{0};
+  uint8_t _count{0};
+};
+
+template<typename Filter>
+class SmoothedThresholdSensor
+    : public BaseSensor<SmoothedThresholdSensor<Filter>, float, esphome::homeassistant::HomeassistantSensor> {
+  using Base = BaseSensor<SmoothedThresholdSensor, float, esphome::homeassistant::HomeassistantSensor>;
+  friend Base;
+
+public:
+  SmoothedThresholdSensor(const char *n, const char *entity, Filter filter, float rise, float fall, uint32_t hold_s)
+    : Base(n, entity, std::numeric_limits<float>::max()),
+      _filter(filter), _rise(rise), _fall(fall), _hold_ms(hold_s * 1000) {}
+
+  // Additionally require the rendered value to change (bands and hold still apply)
+  void set_quantizer(const DisplayQuantizer &q) { _quantizer = q; }
+  const DisplayQuantizer &quantizer() const { return _quantizer; }
+
+protected:
+  // Once per push, before the change check
+  void decode_state() {
+    float raw = this->_get_sensor()->state;
+    if (!std::isnan(raw)) _filter.push(raw);
+  }
+
+  void update_value_from_sensor() {
+    this->_get_value() = _filter.primed() ? _filter.value() : this->_get_sensor()->state;
+  }
+
+  bool is_value_change_significant() {
+    if (!_filter.primed()) return false;
+    float current = _filter.value();
+    float shown = this->_get_value();
+
+    if (shown == std::numeric_limits<float>::max()) {
+      SENSOR_LOGD("%s: Initialized with first value - triggering update", this->name());
+      return trigger_();
+    }
+
+    bool outside = current > shown ? current - shown > _rise : shown - current > _fall;
+    if (!outside) return false;
+    if (_quantizer.enabled() && _quantizer.same_text(current, shown)) return false;
+
+    uint32_t since = millis() - _last_trigger_ms;
+    if (_triggered && since < _hold_ms) {
+      SENSOR_LOGV("%s: Change held (%us since last trigger)", this->name(), (unsigned) (since / 1000));
+      return false;
+    }
+    SENSOR_LOGD("%s: Filtered value %.2f left band around %.2f - triggering update", this->name(), current, shown);
+    return trigger_();
+  }
+
+private:
+  bool trigger_() {
+    _triggered = true;
+    _last_trigger_ms = millis();
+    return true;
+  }
+
+  Filter _filter;
+  float _rise;
+  float _fall;
+  uint32_t _hold_ms;
+  DisplayQuantizer _quantizer;
+  uint32_t _last_trigger_ms{0};
+  bool _triggered{false};
+};
+
+using EmaThresholdSensor = SmoothedThresholdSensor<EmaFilter>;
+template<uint8_t N>
+using MedianThresholdSensor = SmoothedThresholdSensor<MedianFilter<N>>;
+
 // PassiveSensor - Tracks HA connection but never triggers display updates
 template<typename ValueType, typename SensorType>
-class PassiveSensor : public BaseSensor<ValueType, SensorType> {
+class PassiveSensor : public BaseSensor<PassiveSensor<ValueType, SensorType>, ValueType, SensorType> {
+  using Base = BaseSensor<PassiveSensor, ValueType, SensorType>;
+  friend Base;
+
 public:
   PassiveSensor(const char *n, const char *entity, ValueType initial = ValueType())
-    : BaseSensor<ValueType, SensorType>(n, entity, initial) {}
+    : Base(n, entity, initial) {}
 
 protected:
-  bool is_value_change_significant() override {
+  bool is_value_change_significant() {
     return false;
   }
 };
@@ -234,24 +585,30 @@ using FloatPassiveSensor = PassiveSensor<float, esphome::homeassistant::Homeassi
 using WiFiPassiveSensor = PassiveSensor<float, esphome::wifi_signal::WiFiSignalSensor>;
 
 // FilteredTextStateSensor - Ignores transitions to/from specific state values
-class FilteredTextStateSensor : public BaseSensor<std::string, esphome::homeassistant::HomeassistantTextSensor> {
+class FilteredTextStateSensor
+    : public BaseSensor<FilteredTextStateSensor, std::string, esphome::homeassistant::HomeassistantTextSensor> {
+  using Base = BaseSensor<FilteredTextStateSensor, std::string, esphome::homeassistant::HomeassistantTextSensor>;
+  friend Base;
+
 public:
   FilteredTextStateSensor(const char *n, const char *entity, const char *ignored_value)
-    : BaseSensor<std::string, esphome::homeassistant::HomeassistantTextSensor>(n, entity, ""),
+    : Base(n, entity, ""),
       _ignored_value(ignored_value) {}
 
 protected:
-  bool is_value_change_significant() override {
-    std::string current = _get_sensor()->state;
-    std::string cached = _get_value();
+  bool is_value_change_significant() {
+    const std::string &current = _get_sensor()->state;
+    const std::string &cached = _get_value();
 
     if (current == _ignored_value) {
-      ESP_LOGD("main", "%s: Ignoring transition to '%s'", name(), _ignored_value);
+      SENSOR_LOGD("%s: Ignoring transition to '%s'", name(), _ignored_value);
+      set_ignored(true);
       return false;
     }
 
     if (cached == _ignored_value) {
-      ESP_LOGD("main", "%s: Ignoring transition from '%s'", name(), _ignored_value);
+      SENSOR_LOGD("%s: Ignoring transition from '%s'", name(), _ignored_value);
+      set_ignored(true);
       return false;
     }
 
@@ -262,48 +619,839 @@ private:
   const char *_ignored_value;
 };
 
+// ============================================================================
+// ENUM TEXT SENSORS
+// ============================================================================
+// Text entities with a small, known vocabulary (lock, charger, weather) are parsed
+// into an enum once per push. Change detection and rendering are then integer compares.
+//
+// Each enum used with EnumTextSensor specializes EnumTraits:
+//   static constexpr Enum UNKNOWN;           // Sentinel for unrecognized text
+//   static constexpr int COUNT;              // Vocabulary = values 0..COUNT-1
+//   static Enum parse(const char *text);     // UNKNOWN if not in the vocabulary
+//   static const char *name(Enum value);     // For logs
+template<typename Enum>
+struct EnumTraits;
+
+// Vocabulary entry: HA state string -> enum value
+template<typename Enum>
+struct EnumName {
+  const char *text;
+  Enum value;
+};
+
+// Linear lookups for short vocabularies (use a sorted table for long ones - see WEATHER_ICONS)
+template<typename Enum, size_t N>
+Enum enum_from_text(const EnumName<Enum> (&table)[N], const char *text, Enum unknown) {
+  for (const EnumName<Enum> &entry : table) {
+    if (std::strcmp(entry.text, text) == 0) return entry.value;
+  }
+  return unknown;
+}
+
+template<typename Enum, size_t N>
+const char *enum_to_text(const EnumName<Enum> (&table)[N], Enum value) {
+  for (const EnumName<Enum> &entry : table) {
+    if (entry.value == value) return entry.text;
+  }
+  return "unknown";
+}
+
+// EnumTextSensor - Text sensor cached as an enum, optionally ignoring transitions to/from one value
+template<typename Enum>
+class EnumTextSensor
+    : public BaseSensor<EnumTextSensor<Enum>, Enum, esphome::homeassistant::HomeassistantTextSensor> {
+  using Base = BaseSensor<EnumTextSensor, Enum, esphome::homeassistant::HomeassistantTextSensor>;
+  friend Base;
+
+public:
+  using Traits = EnumTraits<Enum>;
+
+  EnumTextSensor(const char *n, const char *entity)
+    : Base(n, entity, Traits::UNKNOWN),
+      _current(Traits::UNKNOWN), _ignored(Traits::UNKNOWN), _filtered(false) {}
+
+  EnumTextSensor(const char *n, const char *entity, Enum ignored)
+    : Base(n, entity, Traits::UNKNOWN),
+      _current(Traits::UNKNOWN), _ignored(ignored), _filtered(true) {}
+
+protected:
+  void decode_state() {
+    if (this->_get_sensor()) {
+      _current = Traits::parse(this->_get_sensor()->state.c_str());
+    }
+  }
+
+  void update_value_from_sensor() { this->_get_value() = _current; }
+
+  float trace_current() const { return static_cast<float>(_current); }
+
+  // Cached enums are indices into the vocabulary - a reordered or edited table starts cold
+  void hash_encoding(uint32_t &hash) const {
+    for (int i = 0; i < Traits::COUNT; i++) {
+      hash = fnv1a(hash, Traits::name(static_cast<Enum>(i)));
+    }
+  }
+
+  bool is_value_change_significant() {
+    Enum cached = this->_get_value();
+
+    if (_filtered && _current == _ignored) {
+      SENSOR_LOGD("%s: Ignoring transition to '%s'", this->name(), Traits::name(_ignored));
+      this->set_ignored(true);
+      return false;
+    }
+
+    if (_filtered && cached == _ignored) {
+      SENSOR_LOGD("%s: Ignoring transition from '%s'", this->name(), Traits::name(_ignored));
+      this->set_ignored(true);
+      return false;
+    }
+
+    return _current != cached;
+  }
+
+private:
+  Enum _current;  // Last pushed state, parsed in decode_state()
+  Enum _ignored;
+  bool _filtered;
+};
+
+// ============================================================================
+// SENSOR REGISTRY
+// ============================================================================
+// Static algorithms over a SensorList generated by SENSOR_REGISTRY(). List provides:
+//   static constexpr int COUNT;
+//   template<typename F> static void for_each(F &&f);  // f(sensor) for every sensor
+template<typename List>
+class SensorRegistry {
+public:
+  static constexpr int COUNT = List::COUNT;
+
+  static void set_default_stale_after(uint32_t seconds) { SensorCore::set_default_stale_after(seconds); }
+
+  static void update_all() {
+    List::for_each([](auto &sensor) { sensor.update(); });
+  }
+
+  template<typename F> static void for_each(F &&f) { List::for_each(f); }
+
+  // Slot numbers, the per-slot tables and the entity_id index (SENSOR_INIT_ALL, on_boot)
+  static void index_sensors() {
+    uint16_t slot = 0;
+    List::for_each([&](auto &sensor) {
+      sensor.set_slot(slot);
+      _cores[slot] = &sensor;
+      _snapshot_appliers[slot] = &apply_snapshot_<std::remove_reference_t<decltype(sensor)>>;
+      _entities[slot] = sensor.entity_id();
+      _ha_entity[slot] = sensor.is_ha_entity();
+      _by_entity[slot] = slot;
+      slot++;
+    });
+    std::sort(_by_entity, _by_entity + COUNT,
+              [](uint16_t a, uint16_t b) { return std::strcmp(_entities[a], _entities[b]) < 0; });
+  }
+
+  // SENSOR_LIST slot for an entity_id (binary search of the sorted index), -1 if not listed.
+  // The (text, len) form takes a key that isn't NUL-terminated (a snapshot field).
+  static int find(const char *entity_id) { return find(entity_id, std::strlen(entity_id)); }
+  static int find(const char *key, size_t len) {
+    const uint16_t *end = _by_entity + COUNT;
+    const uint16_t *it = std::lower_bound(static_cast<const uint16_t *>(_by_entity), end, key,
+        [len](uint16_t slot, const char *k) { return compare_entity_(_entities[slot], k, len) < 0; });
+    return it != end && compare_entity_(_entities[*it], key, len) == 0 ? *it : -1;
+  }
+  static SensorCore *sensor_at(int slot) { return slot >= 0 && slot < COUNT ? _cores[slot] : nullptr; }
+
+  // Snapshot field for the sensor in slot (BaseSensor::apply_snapshot on its concrete type)
+  static SnapshotField apply_snapshot(int slot, const char *text, size_t len) {
+    return _snapshot_appliers[slot](_cores[slot], text, len);
+  }
+
+  // Dirty state - SENSOR_UPDATE_CALLBACK sets a sensor's flag when its change is significant.
+  // A set flag skips further change checks for that sensor until the next refresh takes them.
+  // The count and section mask are kept incrementally, so checks don't scan the list.
+  static bool is_dirty(const SensorCore &sensor) { return sensor.is_dirty(); }
+  static void mark_dirty(SensorCore &sensor) {
+    if (!sensor.set_dirty_flag()) return;
+    _dirty_count++;
+    _dirty_sections |= sensor.sections();
+    if (sensor.is_requested()) _requested_marks++;
+  }
+  static uint16_t dirty_count() { return _dirty_count; }
+  static uint32_t dirty_sections() { return _dirty_sections; }  // Sections drawn by the dirty sensors
+  // Sensors marked dirty while requested by the last begin_ha_request() (stale ones only, for
+  // a stale_only poll), counted since boot - the changes a request's answers brought in
+  static uint32_t requested_marks() { return _requested_marks; }
+
+  // Clear the dirty flags (update_screen, right before update_all()). What was taken stays
+  // available to the renderer via was_dirty()/last_dirty_sections(). Returns the count.
+  static uint16_t take_dirty() {
+    uint16_t taken = _dirty_count;
+    for (SensorCore *core : _cores) core->take_dirty_flag();
+    _last_dirty_sections = _dirty_sections;
+    _dirty_count = 0;
+    _dirty_sections = 0;
+    return taken;
+  }
+  static bool was_dirty(const SensorCore &sensor) { return sensor.was_dirty(); }
+  static uint32_t last_dirty_sections() { return _last_dirty_sections; }
+
+  // Log which sensors caused the refresh (after take_dirty())
+  static void log_dirty() {
+    char names[192];
+    size_t len = 0;
+    int taken = 0;
+    names[0] = '\0';
+    List::for_each([&](auto &sensor) {
+      if (!sensor.was_dirty()) return;
+      taken++;
+      if (len >= sizeof(names)) return;
+      int n = std::snprintf(names + len, sizeof(names) - len, "%s%s", len ? ", " : "", sensor.name());
+      if (n > 0) len += n;
+    });
+    ESP_LOGD("sensor", "Changed sensors: %s (%d, sections 0x%03x)",
+             taken ? names : "none", taken, (unsigned) _last_dirty_sections);
+  }
+
+  // Page visibility - only sensors drawn in the current page's sections trigger a refresh.
+  // Changes to the others are still cached (HIDDEN in the trace) and shown by the full
+  // redraw a page switch does. Sensors without sections always count as visible.
+  static void set_visible_sections(uint32_t sections) { _visible_sections = sections; }
+  static uint32_t visible_sections() { return _visible_sections; }
+  static bool is_visible(const SensorCore &sensor) {
+    return !sensor.sections() || (sensor.sections() & _visible_sections);
+  }
+
+  // Per-sensor push and trigger counts since boot ("Log Sensor Stats" button) - the data
+  // for tuning thresholds and filters against the real HA state stream
+  static void log_stats() {
+    uint32_t uptime_min = millis() / 60000;
+    ESP_LOGI("sensor", "Sensor stats after %u min (pushes / significant):", (unsigned) uptime_min);
+    List::for_each([&](auto &sensor) {
+      uint32_t pushes = sensor.pushes();
+      ESP_LOGI("sensor", "  %-14s %6u / %-6u (%3u%%)", sensor.name(), (unsigned) pushes, (unsigned) sensor.triggers(),
+               (unsigned) (pushes ? sensor.triggers() * 100 / pushes : 0));
+    });
+    ESP_LOGI("sensor", "Callback change detection: %u calls, avg %.1fus, max %uus, %u allocations",
+             (unsigned) homink_diag::callback_count, homink_diag::callback_avg_us(),
+             (unsigned) homink_diag::callback_max_us, (unsigned) homink_diag::callback_allocations);
+    ESP_LOGI("sensor", "Heap: %u free, %u largest block, %u min free; loop stack %u free; last refresh %u allocations (%u B)",
+             (unsigned) homink_diag::free_heap(), (unsigned) homink_diag::largest_free_block(),
+             (unsigned) homink_diag::min_free_heap(), (unsigned) homink_diag::loop_stack_free(),
+             (unsigned) homink_diag::refresh_allocations.count(), (unsigned) homink_diag::refresh_allocations.bytes());
+    ESP_LOGI("sensor", "Refresh latency over the last %u refreshes (min / avg / max):",
+             (unsigned) homink_diag::LATENCY_WINDOW);
+    homink_diag::refresh_timer.log();
+  }
+
+  // Trace ring, oldest first ("Dump Sensor Trace" button) - ms, sensor, decision, old -> new
+  static void dump_trace() {
+    const char *names[COUNT];
+    List::for_each([&](auto &sensor) { names[sensor.slot()] = sensor.name(); });
+    uint32_t now = millis();
+    ESP_LOGI("sensor", "Sensor trace: %u entries, oldest first (age, sensor, decision, old -> new)",
+             (unsigned) homink_diag::trace.count());
+    homink_diag::trace.for_each([&](const homink_diag::TraceEntry &e) {
+      ESP_LOGI("sensor", "  -%7ums %-14s %-15s %g -> %g", (unsigned) (now - e.ms),
+               e.sensor < COUNT ? names[e.sensor] : "?", homink_diag::trace_decision_name(e.decision),
+               e.old_value, e.new_value);
+    });
+  }
+
+  // Completion barrier for homeassistant.update_entity - call right before the service calls,
+  // then send one call per next_ha_request_chunk() (entity_id from ha_request_list(), HA
+  // entities only - no ESPHome built-ins) and wait_until ha_request_complete() with a timeout
+  // instead of a fixed delay. stale_only requests just the sensors that went quiet longer than
+  // their staleness budget. Returns the number of entities requested (0 = skip the service call).
+  // A follower only requests entities quiet for longer than its resync budget.
+  // Requested sensors that pushed within their staleness budget count as answered right away.
+  static int begin_ha_request(bool stale_only = false) {
+    uint32_t now = millis();
+    int count = 0;
+    int fresh = 0;
+    bool follower = _follower_after_ms > 0;
+    List::for_each([&](auto &sensor) {
+      bool wanted = follower ? sensor.is_stale(now, _follower_after_ms) : !stale_only || sensor.is_stale(now);
+      sensor.set_requested(sensor.is_ha_entity() && wanted);
+      if (!sensor.is_requested()) return;
+      count++;
+      if (!sensor.is_stale(now)) {
+        sensor.answer_request();
+        fresh++;
+      }
+    });
+    _request_count = count;
+    _request_fresh = fresh;
+    _request_cursor = 0;
+    _request_list.clear();  // Keeps capacity - no reallocation after the first cycle
+    _request_start_ms = now;
+    _request_sent_ms = now;
+    if (stale_only) {
+      ESP_LOGD("sensor", "Stale entities: %d", count);
+    }
+    return count;
+  }
+
+  // Next update_entity batch into ha_request_list(): up to set_request_chunk() entities, or the
+  // snapshot entity once (one state message resyncs every entity). False when all were sent.
+  // Small batches with a delay between them keep a 100+ entity resync from flooding the API
+  // connection and HA's state machine in one burst.
+  static bool next_ha_request_chunk() {
+    _request_list.clear();
+    if (_request_cursor >= COUNT || _request_count == 0) return false;
+    if (_snapshot_entity) {
+      _request_list = _snapshot_entity;
+      _request_cursor = COUNT;
+      _request_sent_ms = millis();
+      return true;
+    }
+    int taken = 0;
+    while (_request_cursor < COUNT && taken < _request_chunk) {
+      uint16_t slot = _request_cursor++;
+      if (!_cores[slot]->is_requested()) continue;
+      if (taken++ > 0) _request_list += ",";
+      _request_list += _entities[slot];
+    }
+    while (_request_cursor < COUNT && !_cores[_request_cursor]->is_requested()) _request_cursor++;
+    ESP_LOGV("sensor", "update_entity batch: %s", _request_list.c_str());
+    _request_sent_ms = millis();
+    return taken > 0;
+  }
+  static bool ha_request_chunks_left() { return _request_count > 0 && _request_cursor < COUNT; }
+
+  // Entities in the current batch / requested by the last begin_ha_request()
+  static const std::string &ha_request_list() { return _request_list; }
+  static int ha_request_count() { return _request_count; }
+
+  // Entities per update_entity call (ha_request_chunk_size)
+  static void set_request_chunk(int entities) { _request_chunk = std::max(entities, 1); }
+
+  // Number of requested HA sensors that haven't answered the current request
+  static int ha_request_pending() { return SensorCore::requests_outstanding(); }
+
+  // Every requested entity answered, or the answers settled: HA sends the changed states
+  // back-to-back right after update_entity, and nothing at all for unchanged ones, so once
+  // no push arrived for the settle time after the last batch the rest are taken as unchanged.
+  // ha_response_timeout stays the cap for an HA that is slow to answer at all.
+  static bool ha_request_complete() { return ha_request_pending() == 0 || ha_request_settled(); }
+  static bool ha_request_settled() {
+    uint32_t now = millis();
+    uint32_t quiet = now - _request_sent_ms;
+    if (SensorCore::any_pushed()) quiet = std::min(quiet, now - SensorCore::newest_push_ms());
+    return quiet >= _request_settle_ms;
+  }
+
+  // Quiet time that ends the wait for unchanged entities (ha_response_settle_ms)
+  static void set_request_settle(uint32_t ms) { _request_settle_ms = ms; }
+
+  // Log how long the barrier waited (call after the wait_until)
+  static void log_ha_request() {
+    uint32_t waited = millis() - _request_start_ms;
+    int pending = ha_request_pending();
+    if (pending == 0) {
+      ESP_LOGD("sensor", "All %d HA entities answered in %ums (%d fresh)", _request_count, (unsigned) waited,
+               _request_fresh);
+    } else if (ha_request_settled()) {
+      // Entities whose state didn't change are not re-sent by HA
+      ESP_LOGD("sensor", "HA answers settled after %ums (%d of %d entities unchanged)",
+               (unsigned) waited, pending, _request_count);
+    } else {
+      ESP_LOGD("sensor", "HA request timed out after %ums (%d of %d entities unanswered)",
+               (unsigned) waited, pending, _request_count);
+    }
+  }
+
+  // Sync window - after an API (re)connect HA re-sends every subscribed entity back-to-back.
+  // While it is open SENSOR_UPDATE_CALLBACK only records values and dirty flags; it closes once
+  // every HA entity has pushed (or the caller's timeout), and one refresh shows the whole burst.
+  // Unchanged binary sensors aren't re-published, so the timeout is the common close.
+  static void begin_sync() {
+    _sync_start_ms = millis();
+    _syncing = true;
+    for (uint16_t slot = 0; slot < COUNT; slot++) _cores[slot]->set_sync_waiting(_ha_entity[slot]);
+  }
+  static bool syncing() { return _syncing; }
+
+  // HA entities that haven't pushed since begin_sync()
+  static int sync_pending() { return SensorCore::sync_outstanding(); }
+  static bool sync_complete() { return sync_pending() == 0; }
+
+  static void end_sync() {
+    _syncing = false;
+    int silent = sync_pending();
+    for (SensorCore *core : _cores) core->set_sync_waiting(false);
+    ESP_LOGD("sensor", "Sync window closed after %ums (%d entities silent, %u dirty)",
+             (unsigned) (millis() - _sync_start_ms), silent, (unsigned) _dirty_count);
+  }
+
+  // Milliseconds since the newest push from any sensor (UINT32_MAX before the first one)
+  static uint32_t ms_since_last_push() {
+    return SensorCore::any_pushed() ? millis() - SensorCore::newest_push_ms() : UINT32_MAX;
+  }
+
+  // Cost of the per-push and per-tick registry paths ("Benchmark Sensor Paths" button).
+  // Every one is O(1) or O(log n) in the sensor count; run it on a large SENSOR_LIST to
+  // check the numbers stay flat.
+  static void benchmark(uint32_t iterations) {
+    volatile uint32_t sink = 0;  // Keeps the loops from being optimized away
+    auto run = [&](const char *what, auto &&op) {
+      uint32_t start = micros();
+      for (uint32_t i = 0; i < iterations; i++) sink = sink + op(i);
+      uint32_t us = micros() - start;
+      ESP_LOGI("sensor", "  %-22s %7.1f ns/call", what, us * 1000.0f / iterations);
+    };
+    ESP_LOGI("sensor", "Registry benchmark: %d sensors, %u iterations", COUNT, (unsigned) iterations);
+    run("is_dirty + is_visible", [](uint32_t i) {
+      const SensorCore &core = *_cores[i % COUNT];
+      return uint32_t(is_dirty(core)) + is_visible(core);
+    });
+    run("ha_request_complete", [](uint32_t) { return uint32_t(ha_request_complete()); });
+    run("sync_complete", [](uint32_t) { return uint32_t(sync_complete()); });
+    run("ms_since_last_push", [](uint32_t) { return ms_since_last_push(); });
+    run("find(entity_id)", [](uint32_t i) { return uint32_t(find(_entities[i % COUNT])); });
+    ESP_LOGI("sensor", "  callback change detection: avg %.1fus, max %uus over %u calls",
+             homink_diag::callback_avg_us(), (unsigned) homink_diag::callback_max_us,
+             (unsigned) homink_diag::callback_count);
+  }
+
+  // Warm-boot cache - the displayed values, persisted through ESPHome preferences (NVS, flushed
+  // every flash_write_interval and on safe shutdown/OTA). Restored on boot so the first frame
+  // shows the last known values instead of placeholders; live pushes then only trigger a refresh
+  // when they differ. Saved only when the values changed, at most every min_interval_s
+  // (force = on shutdown).
+  static bool restore_warm_cache() {
+    WarmCache cache;
+    if (!warm_preference_().load(&cache) || cache.count != COUNT) {
+      ESP_LOGI("sensor", "No warm-boot cache - first frame waits for HA");
+      return false;
+    }
+    int restored = 0;
+    uint16_t slot = 0;
+    List::for_each([&](auto &sensor) {
+      if (cache.has_state[slot / 32] & (1u << (slot % 32))) {
+        sensor.warm_restore(cache.cells[slot]);
+        restored++;
+      }
+      slot++;
+    });
+    _warm_saved = cache;
+    ESP_LOGI("sensor", "Warm boot: restored %d cached values", restored);
+    return restored > 0;
+  }
+
+  static void save_warm_cache(uint32_t min_interval_s, bool force = false) {
+    WarmCache cache;
+    cache.count = COUNT;
+    uint16_t slot = 0;
+    List::for_each([&](auto &sensor) {
+      uint32_t cell = 0;
+      if (sensor.warm_encode(cell)) {
+        cache.has_state[slot / 32] |= 1u << (slot % 32);
+        cache.cells[slot] = cell;
+      }
+      slot++;
+    });
+    if (std::memcmp(&cache, &_warm_saved, sizeof(cache)) == 0) return;
+    uint32_t now = millis();
+    if (!force && _warm_saved_ms && now - _warm_saved_ms < min_interval_s * 1000) return;
+    if (warm_preference_().save(&cache)) {
+      _warm_saved = cache;
+      _warm_saved_ms = now;
+      ESP_LOGD("sensor", "Warm-boot cache saved");
+    }
+  }
+
+  // Snapshot mode - begin_ha_request() asks HA for the packed snapshot entity instead
+  // of the individual entities (SnapshotSensor answers them all with one decode)
+  static void use_snapshot(const char *entity) { _snapshot_entity = entity; }
+  static const char *snapshot_entity() { return _snapshot_entity; }
+
+  // Follower mode - another unit (the leader) issues update_entity for the shared entities and
+  // this one relies on the resulting pushes. Entities quiet for resync_s (leader offline) are
+  // still requested. 0 = leader / standalone.
+  static void set_follower(uint32_t resync_s) { _follower_after_ms = resync_s * 1000; }
+  static bool is_follower() { return _follower_after_ms > 0; }
+
+private:
+  struct WarmCache {
+    uint32_t count{0};
+    uint32_t has_state[(COUNT + 31) / 32]{};
+    uint32_t cells[COUNT]{};
+  };
+
+  // Keyed by the entity list and the enum vocabularies, so a changed SENSOR_LIST or
+  // WEATHER_ICONS table never restores into the wrong sensors or conditions
+  static esphome::ESPPreferenceObject &warm_preference_() {
+    static esphome::ESPPreferenceObject pref = [] {
+      uint32_t hash = 2166136261u ^ WARM_CACHE_VERSION;  // FNV offset basis
+      List::for_each([&](auto &sensor) {
+        hash = fnv1a(hash, sensor.entity_id());
+        sensor.warm_hash(hash);
+      });
+      return esphome::global_preferences->template make_preference<WarmCache>(hash);
+    }();
+    return pref;
+  }
+
+  static constexpr uint32_t WARM_CACHE_VERSION = 3;  // Bump when a cached value's encoding changes
+
+  static WarmCache _warm_saved;
+  static uint32_t _warm_saved_ms;
+  static const char *_snapshot_entity;
+  static bool _syncing;
+  static uint32_t _sync_start_ms;
+  static uint32_t _follower_after_ms;
+  static uint32_t _request_start_ms;
+  static std::string _request_list;
+  static int _request_count;
+  static int _request_fresh;
+  static uint32_t _request_sent_ms;
+  static uint32_t _request_settle_ms;
+  static uint16_t _request_cursor;
+  static int _request_chunk;
+  static uint16_t _dirty_count;
+  static uint32_t _dirty_sections;
+  static uint32_t _requested_marks;
+  static uint32_t _last_dirty_sections;
+  static uint32_t _visible_sections;
+  // strcmp() of entity against the first len characters of key
+  static int compare_entity_(const char *entity, const char *key, size_t len) {
+    int c = std::strncmp(entity, key, len);
+    return c ? c : entity[len] != '\0';
+  }
+
+  using SnapshotApplier = SnapshotField (*)(SensorCore *, const char *, size_t);
+  template<typename S> static SnapshotField apply_snapshot_(SensorCore *core, const char *text, size_t len) {
+    return static_cast<S *>(core)->apply_snapshot(text, len);
+  }
+
+  static SensorCore *_cores[COUNT];
+  static SnapshotApplier _snapshot_appliers[COUNT];
+  static const char *_entities[COUNT];
+  static bool _ha_entity[COUNT];
+  static uint16_t _by_entity[COUNT];  // Slots sorted by entity_id
+};
+
+template<typename List>
+typename SensorRegistry<List>::WarmCache SensorRegistry<List>::_warm_saved;
+template<typename List>
+uint32_t SensorRegistry<List>::_warm_saved_ms = 0;
+template<typename List>
+const char *SensorRegistry<List>::_snapshot_entity = nullptr;
+template<typename List>
+bool SensorRegistry<List>::_syncing = false;
+template<typename List>
+uint32_t SensorRegistry<List>::_sync_start_ms = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_follower_after_ms = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_request_start_ms = 0;
+template<typename List>
+std::string SensorRegistry<List>::_request_list;
+template<typename List>
+int SensorRegistry<List>::_request_count = 0;
+template<typename List>
+int SensorRegistry<List>::_request_fresh = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_request_sent_ms = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_request_settle_ms = 300;
+template<typename List>
+uint16_t SensorRegistry<List>::_request_cursor = 0;
+template<typename List>
+int SensorRegistry<List>::_request_chunk = 20;
+template<typename List>
+uint16_t SensorRegistry<List>::_dirty_count = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_dirty_sections = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_requested_marks = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_last_dirty_sections = 0;
+template<typename List>
+uint32_t SensorRegistry<List>::_visible_sections = UINT32_MAX;
+template<typename List>
+SensorCore *SensorRegistry<List>::_cores[COUNT];
+template<typename List>
+typename SensorRegistry<List>::SnapshotApplier SensorRegistry<List>::_snapshot_appliers[COUNT];
+template<typename List>
+const char *SensorRegistry<List>::_entities[COUNT];
+template<typename List>
+bool SensorRegistry<List>::_ha_entity[COUNT];
+template<typename List>
+uint16_t SensorRegistry<List>::_by_entity[COUNT];
+
+// ============================================================================
+// SNAPSHOT SENSOR
+// ============================================================================
+// Optional packed dashboard state (homink-snapshot.inc): one HA template sensor
+// carries every HA entity of SENSOR_LIST in a "snapshot" attribute (attribute
+// values aren't capped at 255 characters like states) as a versioned record of
+// '|'-separated fields - the version, a stamp, then entity_id=state:
+//
+//   3|1791234567.1|binary_sensor.gate=on|lock.shed_lock=locked|sun.sun=-0.8|sensor.temp=71.3
+//
+// (binary sensors as on/off, text as the raw state, numbers as numbers). The HA
+// template is trigger-based and renders only on homeassistant.update_entity for
+// itself, so regular state changes cost their individual push and nothing more. The
+// stamp makes each answer differ from the last one (HA doesn't re-send an unchanged
+// attribute). Fields are looked up with Sensors::find(), so their order is free and
+// the record can list entities another unit doesn't have. A full resync is one
+// update_entity, one state message and one decode. Each field is fanned out to the
+// sensor's component: changed values go through on_value -> SENSOR_UPDATE_CALLBACK
+// like a push (same change detection), unchanged ones just answer the request. An
+// empty or malformed value (entity unavailable) is skipped and left to the regular push.
+//
+// The first valid record - on API connect HA sends the current one - switches resync
+// requests to the snapshot entity (Sensors::use_snapshot()); a record with another
+// version switches them back. Only a record answering a pending request is applied:
+// the one sent on connect can be older than the individual states arriving with it.
+
+template<typename Registry>
+class SnapshotSensor {
+public:
+  static constexpr char VERSION = '3';
+  static constexpr char SEPARATOR = '|';
+
+  // Returns false (and applies nothing) for a wrong version
+  bool decode(const std::string &record, const char *entity) {
+    const char *p = record.c_str();
+    if (p[0] != VERSION || p[1] != SEPARATOR) {
+      ESP_LOGW("sensor", "Snapshot version mismatch (expected %c): %.16s", VERSION, p);
+      if (Registry::snapshot_entity()) {
+        ESP_LOGW("sensor", "Snapshot mode off - requesting entities individually");
+        Registry::use_snapshot(nullptr);
+      }
+      return false;
+    }
+    if (!Registry::snapshot_entity()) {
+      Registry::use_snapshot(entity);
+      log_fields();
+    }
+    if (Registry::ha_request_pending() == 0) {
+      ESP_LOGD("sensor", "Snapshot record without a pending request - not applied");
+      return true;
+    }
+    p += 2;
+    const char *stamp_end = std::strchr(p, SEPARATOR);  // Stamp - only there to make the record change
+    p = stamp_end ? stamp_end + 1 : p + std::strlen(p);
+
+    int fields = 0;
+    int published = 0;
+    int invalid = 0;
+    int unknown = 0;
+    while (*p) {
+      const char *end = std::strchr(p, SEPARATOR);
+      size_t len = end ? static_cast<size_t>(end - p) : std::strlen(p);
+      const char *eq = static_cast<const char *>(std::memchr(p, '=', len));
+      int slot = eq ? Registry::find(p, eq - p) : -1;
+      fields++;
+      if (slot < 0) {
+        unknown++;
+      } else {
+        SnapshotField result = Registry::apply_snapshot(slot, eq + 1, p + len - eq - 1);
+        published += result == SnapshotField::PUBLISHED;
+        invalid += result == SnapshotField::INVALID;
+      }
+      p += len + (end ? 1 : 0);
+    }
+    _decoded++;
+    ESP_LOGD("sensor", "Snapshot decoded: %d fields, %d changed, %d unavailable or malformed, %d not in SENSOR_LIST",
+             fields, published, invalid, unknown);
+    return true;
+  }
+
+  // Entities the HA template should list (logged when snapshot mode turns on)
+  void log_fields() const {
+    ESP_LOGI("sensor", "Snapshot mode on (%s), version %c, entities:", Registry::snapshot_entity(), VERSION);
+    Registry::for_each([](auto &sensor) {
+      if (sensor.is_ha_entity()) ESP_LOGI("sensor", "  %s", sensor.entity_id());
+    });
+  }
+
+  uint32_t decoded() const { return _decoded; }
+
+private:
+  uint32_t _decoded{0};
+};
+
+// ============================================================================
+// ADAPTIVE POLLING
+// ============================================================================
+// Backup poll interval driven by push health. A clean poll (nothing stale, or its answers
+// held no change the pushes had missed) doubles the interval up to the maximum. A poll
+// that catches a missed change, pushes going quiet, or a reconnect snaps it back to the
+// minimum. Only the update_entity poll is gated - the forced-refresh and HA-timeout checks
+// run on every poll tick regardless of the interval.
+
+class PollController {
+public:
+  // min_s = poll tick, max_s = widest interval, quiet_s = no push from any sensor this long
+  void configure(uint32_t min_s, uint32_t max_s, uint32_t quiet_s) {
+    _min_ms = min_s * 1000;
+    _max_ms = std::max(max_s, min_s) * 1000;
+    _quiet_ms = quiet_s * 1000;
+    _interval_ms = _min_ms;
+  }
+
+  // Poll tick - true when the current interval has elapsed since the last poll
+  bool due(uint32_t ms_since_push) {
+    if (ms_since_push >= _quiet_ms) reset("pushes quiet");
+    // Ticks land on the minimum interval; the slack absorbs scheduler jitter
+    return !_polls || millis() - _last_poll_ms + TICK_SLACK_MS >= _interval_ms;
+  }
+
+  // Bracket one poll with Sensors::requested_marks() before and after its update_entity
+  // answers: only a change of an entity the poll requested counts as caught, not the
+  // regular pushes of a busy period. update_screen waits while a poll is in flight - both
+  // use the begin_ha_request() barrier.
+  void begin(uint32_t requested_marks) {
+    _marks_before = requested_marks;
+    _in_flight = true;
+  }
+  void finish(uint32_t requested_marks, bool requested) {
+    _in_flight = false;
+    _last_poll_ms = millis();
+    _polls++;
+    _requests += requested;
+    if (requested && requested_marks != _marks_before) {
+      reset("poll caught a change the pushes missed");
+    } else if (_interval_ms < _max_ms) {
+      _interval_ms = std::min(_interval_ms * 2, _max_ms);
+      ESP_LOGD("sensor", "Pushes healthy - poll interval widened to %us", (unsigned) interval_s());
+    }
+  }
+
+  // Back to the minimum interval (API reconnect, HA timeout, WiFi loss)
+  void reset(const char *reason) {
+    if (_interval_ms == _min_ms) return;
+    _interval_ms = _min_ms;
+    ESP_LOGI("sensor", "Poll interval back to %us: %s", (unsigned) interval_s(), reason);
+  }
+
+  bool in_flight() const { return _in_flight; }
+  uint32_t interval_s() const { return _interval_ms / 1000; }
+  uint32_t polls() const { return _polls; }        // Polls run (interval elapsed)
+  uint32_t requests() const { return _requests; }  // Polls that sent update_entity
+
+private:
+  static constexpr uint32_t TICK_SLACK_MS = 1000;
+
+  uint32_t _min_ms{15000};
+  uint32_t _max_ms{15000};
+  uint32_t _quiet_ms{60000};
+  uint32_t _interval_ms{15000};
+  uint32_t _last_poll_ms{0};
+  uint32_t _marks_before{0};
+  uint32_t _polls{0};
+  uint32_t _requests{0};
+  bool _in_flight{false};
+};
+
+PollController poll_controller;
+
 // ============================================================================
 // MACROS
 // ============================================================================
 
-// Unified callback - checks availability and value changes, triggers immediate update if allowed
+// Unified callback - checks availability and value changes, sets the sensor's dirty flag and
+// arms the schedule_refresh timer unless it is already armed (later changes fold into it)
+// or the reconnect sync window is open (sync_window schedules the refresh when it closes).
+// A change to a sensor not drawn on the current page (Sensors::is_visible()) is only cached.
 // Uses do-while(0) pattern for safe macro expansion (works correctly with if/else, no dangling statements)
 #define SENSOR_UPDATE_CALLBACK(sensor_var) \
   do { \
-    id(last_ha_connection_time) = id(homeassistant_time).now().timestamp; \
+    sensor_var.mark_updated(); \
+    long now_s = id(homeassistant_time).now().timestamp; \
+    id(last_ha_connection_time) = now_s; \
     if (!id(ha_connected)) { \
       ESP_LOGD("main", "Received sensor data - marking HA as connected"); \
       id(ha_connected) = true; \
     } \
-    if (!id(data_updated) && sensor_var.should_trigger_update()) { \
+    float trace_old = sensor_var.trace_value(); \
+    bool pending = Sensors::is_dirty(sensor_var); \
+    uint32_t allocs_before = homink_diag::allocation_count(); \
+    uint32_t check_start = micros(); \
+    bool changed = !pending && sensor_var.should_trigger_update(); \
+    bool hidden = changed && !Sensors::is_visible(sensor_var); \
+    bool significant = changed && !hidden; \
+    homink_diag::record_callback(micros() - check_start); \
+    homink_diag::callback_allocations += homink_diag::allocation_count() - allocs_before; \
+    homink_diag::TraceDecision decision = pending ? homink_diag::TraceDecision::PENDING \
+        : hidden ? homink_diag::TraceDecision::HIDDEN \
+        : sensor_var.was_ignored() ? homink_diag::TraceDecision::IGNORED \
+        : homink_diag::TraceDecision::BELOW_THRESHOLD; \
+    if (significant) { \
+      decision = homink_diag::TraceDecision::DEFERRED; \
+      sensor_var.record_trigger(); \
+      Sensors::mark_dirty(sensor_var); \
+      homink_diag::refresh_timer.note_trigger(); \
       id(data_updated) = true; \
-      long time_since_refresh = id(homeassistant_time).now().timestamp - id(last_display_refresh_time); \
-      if (time_since_refresh >= id(threshold_min_update_interval) || id(last_display_refresh_time) == 0) { \
-        ESP_LOGD("main", "%s: Immediate update (%lds since last refresh)", sensor_var.name(), time_since_refresh); \
-        id(update_screen).execute(); \
-      } else { \
-        ESP_LOGD("main", "%s: Deferred update (%lds < %ds min interval)", sensor_var.name(), time_since_refresh, id(threshold_min_update_interval)); \
+      if (!Sensors::syncing() && !id(schedule_refresh).is_running()) { \
+        decision = homink_diag::TraceDecision::IMMEDIATE; \
+        SENSOR_LOGD("%s: Scheduling update (%lds since last refresh)", sensor_var.name(), \
+                    now_s - id(last_display_refresh_time)); \
+        id(schedule_refresh).execute(); \
       } \
     } \
+    homink_diag::trace.record(sensor_var.slot(), decision, trace_old, sensor_var.trace_state()); \
   } while(0)
 
 // ============================================================================
 // X-MACRO SYSTEM
 // ============================================================================
+// Device headers list every sensor once and then expand the registry:
+//
+//   #define SENSOR_LIST(X)  X(SENSOR_BINARY, S_GATE1, SECTION_GATE1, "Sidewalk", "binary_sensor.gate")
+//                           X(SENSOR_THRESHOLD, S_TEMPERATURE, SECTION_WEATHER, "Temperature", "sensor.temp", 1.0)
+//   SENSOR_REGISTRY()
+//
+// (one X() entry per line, joined with line continuations)
+//
 // SENSOR_* macros expand to C++ variable declarations.
-// SENSOR_INIT_* macros expand to set_sensor() calls.
+// The third field is the DisplaySection mask the sensor is drawn in (homink_display.h).
+// SENSOR_INIT_ALL() links every listed sensor to its ESPHome sensor - a sensor
+// without a matching YAML block (id: _var) is a compile error in main.cpp.
 // ESPHome prepends "_" to variable names (gate1 → _gate1).
 #define SENSOR_BINARY(var, name, entity)                 BinaryStateSensor var(name, entity);
 #define SENSOR_TEXT(var, name, entity)                   TextStateSensor var(name, entity);
 #define SENSOR_TEXT_FILTERED(var, name, entity, ignored) FilteredTextStateSensor var(name, entity, ignored);
+#define SENSOR_TEXT_ENUM(var, name, entity, Enum)                   EnumTextSensor<Enum> var(name, entity);
+#define SENSOR_TEXT_ENUM_FILTERED(var, name, entity, Enum, ignored) EnumTextSensor<Enum> var(name, entity, ignored);
 #define SENSOR_THRESHOLD(var, name, entity, thresh)      FloatThresholdSensor var(name, entity, thresh);
+#define SENSOR_THRESHOLD_EMA(var, name, entity, alpha, rise, fall, hold_s) \
+  EmaThresholdSensor var(name, entity, EmaFilter(alpha), rise, fall, hold_s);
+#define SENSOR_THRESHOLD_MEDIAN(var, name, entity, window, rise, fall, hold_s) \
+  MedianThresholdSensor<window> var(name, entity, MedianFilter<window>(), rise, fall, hold_s);
 #define SENSOR_PASSIVE(var, name, entity)                FloatPassiveSensor var(name, entity);
 #define SENSOR_WIFI(var, name, entity)                   WiFiPassiveSensor var(name, entity);
 
-#define _SENSOR_INIT(var)              var.set_sensor(&id(_##var));
-#define SENSOR_INIT_BINARY(var)        _SENSOR_INIT(var)
-#define SENSOR_INIT_TEXT(var)          _SENSOR_INIT(var)
-#define SENSOR_INIT_TEXT_FILTERED(var) _SENSOR_INIT(var)
-#define SENSOR_INIT_THRESHOLD(var)     _SENSOR_INIT(var)
-#define SENSOR_INIT_PASSIVE(var)       _SENSOR_INIT(var)
-#define SENSOR_INIT_WIFI(var)          _SENSOR_INIT(var)
+// SENSOR_LIST entry expansions
+#define _SENSOR_DECLARE(type, var, sections, ...) type(var, __VA_ARGS__)
+#define _SENSOR_COUNT(type, var, sections, ...)   + 1
+#define _SENSOR_VISIT(type, var, sections, ...)   f(var);
+#define _SENSOR_LINK(type, var, sections, ...)    _SENSOR_INIT(var) var.set_sections(sections);
+#define _SENSOR_INIT(var)                         var.set_sensor(&id(_##var));
+
+#define SENSOR_REGISTRY() \
+  SENSOR_LIST(_SENSOR_DECLARE) \
+  struct SensorList { \
+    static constexpr int COUNT = 0 SENSOR_LIST(_SENSOR_COUNT); \
+    template<typename F> static void for_each(F &&f) { SENSOR_LIST(_SENSOR_VISIT) } \
+  }; \
+  static_assert(SensorList::COUNT > 0, "SENSOR_LIST is empty"); \
+  static_assert(SensorList::COUNT <= UINT16_MAX, "Sensor slots are 16-bit"); \
+  using Sensors = SensorRegistry<SensorList>; \
+  SnapshotSensor<Sensors> ha_snapshot;
+
+// Init macro - links C++ sensors to ESPHome sensors (call in on_boot lambda)
+#define SENSOR_INIT_ALL() SENSOR_LIST(_SENSOR_LINK) Sensors::index_sensors();
+
+// Per-sensor staleness budget override (use in the device SENSOR_STALENESS_ALL() macro)
+#define SENSOR_STALE_AFTER(var, seconds) var.set_stale_after(seconds);
+
+// Per-sensor display quantizer (use in the device SENSOR_QUANTIZERS_ALL() macro, expanded
+// in on_boot so id() globals such as tesla_power_factor are available)
+#define SENSOR_QUANTIZE(var, format, scale, divisor, floor, idle) \
+  var.set_quantizer(DisplayQuantizer{format, scale, divisor, floor, idle});
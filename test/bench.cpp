@@ -0,0 +1,153 @@
+// Registry cost against SENSOR_LIST size, on synthetic lists from bench_list.py.
+//
+//   build/bench-200 [-H] [-n rounds]
+//
+// One row per binary (make -C test bench runs 13, 50, 100 and 200 sensors). The
+// per-push paths should stay flat as the list grows:
+//   push      publish to a component -> on_value -> SENSOR_UPDATE_CALLBACK (change
+//             detection, dirty flags, trace), every push a significant change
+//   find      Sensors::find(entity_id) - the snapshot decode's lookup
+// and the per-refresh / per-resync ones linear, with a flat cost per sensor:
+//   refresh   Sensors::take_dirty() + Sensors::update_all() after a push to every sensor
+//   resync    begin_ha_request() and every update_entity batch (next_ha_request_chunk())
+//   snapshot  SnapshotSensor::decode() of a record listing every HA entity
+// Times are host nanoseconds (medians of the rounds) - compare sizes, not devices.
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "host_device.h"  // Last: defines id()
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ns(Clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Median of rounds of op(), each timed as a whole and divided by per_round
+template<typename F> double median_ns(int rounds, double per_round, F &&op) {
+  std::vector<double> samples;
+  for (int r = 0; r < rounds; r++) {
+    auto start = Clock::now();
+    op();
+    samples.push_back(elapsed_ns(start) / per_round);
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+// Two states per sensor that always differ after parsing (text: each one is UNKNOWN
+// to one of the vocabularies, so locks and chargers both see a change)
+const char *state_of(esphome::sensor::Sensor &, int phase) { return phase ? "1000" : "0"; }
+const char *state_of(esphome::binary_sensor::BinarySensor &, int phase) { return phase ? "on" : "off"; }
+const char *state_of(esphome::text_sensor::TextSensor &, int phase) { return phase ? "charging" : "locked"; }
+
+#define BENCH_STATE(type, var, sections, ...) BENCH_STATE_(var)
+#define BENCH_STATE_(var) [](int phase) { return state_of(_##var, phase); },
+const char *(*const STATES[])(int) = {SENSOR_LIST(BENCH_STATE)};
+
+// Full snapshot record in one phase, HA entities only (the template can't see wifisignal)
+std::string snapshot_record(int phase) {
+  std::string record = {decltype(ha_snapshot)::VERSION, '|', char('0' + phase)};
+  Sensors::for_each([&](auto &sensor) {
+    if (!sensor.is_ha_entity()) return;
+    record += "|";
+    record += sensor.entity_id();
+    record += "=";
+    record += STATES[sensor.slot()](phase);
+  });
+  return record;
+}
+
+// Refresh side: take the flags and cache the values, as update_screen does
+void refresh() {
+  Sensors::take_dirty();
+  Sensors::update_all();
+  data_updated = false;
+  schedule_refresh.stop();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool header = false;
+  int rounds = 101;
+  int opt;
+  while ((opt = getopt(argc, argv, "Hn:")) != -1) {
+    switch (opt) {
+      case 'H': header = true; break;
+      case 'n': rounds = std::max(1, std::atoi(optarg)); break;
+      default:
+        std::fprintf(stderr, "Usage: %s [-H] [-n rounds]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  host::log_level = 1;
+  host::boot(60);
+  const int count = Sensors::COUNT;
+  int phase = 0;
+  auto publish_all = [&] {
+    phase ^= 1;
+    for (int slot = 0; slot < count; slot++) HOST_PUBLISHERS[slot](STATES[slot](phase));
+  };
+  publish_all();  // First push of every sensor (availability change)
+  refresh();
+
+  // Pushes between refreshes, so each one finds its sensor clean and runs the full check,
+  // and every refresh takes and caches a full set of changes
+  std::vector<double> push_samples, refresh_samples;
+  for (int r = 0; r < rounds; r++) {
+    auto start = Clock::now();
+    publish_all();
+    push_samples.push_back(elapsed_ns(start) / count);
+    start = Clock::now();
+    refresh();
+    refresh_samples.push_back(elapsed_ns(start));
+  }
+  std::sort(push_samples.begin(), push_samples.end());
+  std::sort(refresh_samples.begin(), refresh_samples.end());
+  double push_ns = push_samples[push_samples.size() / 2];
+  double refresh_ns = refresh_samples[refresh_samples.size() / 2];
+
+  std::vector<const char *> entities;
+  Sensors::for_each([&](auto &sensor) { entities.push_back(sensor.entity_id()); });
+  const int finds = 10000;
+  volatile int sink = 0;
+  double find_ns = median_ns(rounds, finds, [&] {
+    for (int i = 0; i < finds; i++) sink = sink + Sensors::find(entities[i % count]);
+  });
+
+  double resync_ns = median_ns(rounds, 1, [&] {
+    Sensors::begin_ha_request();
+    while (Sensors::next_ha_request_chunk()) {}
+  });
+
+  // Each record answers a resync of every sensor (unrequested records aren't applied, and
+  // sensors that pushed within their staleness budget aren't asked)
+  const std::string records[2] = {snapshot_record(0), snapshot_record(1)};
+  std::vector<double> snapshot_samples;
+  for (int r = 0; r < rounds; r++) {
+    host::clock_ms += 3600 * 1000;
+    Sensors::begin_ha_request();
+    auto start = Clock::now();
+    ha_snapshot.decode(records[r % 2], "sensor.homink_snapshot");
+    snapshot_samples.push_back(elapsed_ns(start));
+  }
+  std::sort(snapshot_samples.begin(), snapshot_samples.end());
+  double snapshot_ns = snapshot_samples[snapshot_samples.size() / 2];
+  Sensors::use_snapshot(nullptr);
+
+  if (header) {
+    std::printf("ns per call; refresh, resync and snapshot as total / per sensor\n");
+    std::printf("%7s  %7s  %6s  %14s  %14s  %14s\n", "sensors", "push", "find", "refresh", "resync", "snapshot");
+  }
+  std::printf("%7d  %7.0f  %6.1f  %8.0f / %3.0f  %8.0f / %3.0f  %8.0f / %3.0f\n", count, push_ns, find_ns,
+              refresh_ns, refresh_ns / count, resync_ns, resync_ns / count, snapshot_ns, snapshot_ns / count);
+  return 0;
+}
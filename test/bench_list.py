@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Synthetic device header with a SENSOR_LIST of a given size, for the scaling benchmark.
+
+  bench_list.py 200 build/bench/200/homink-bench.h
+
+The list cycles through the SENSOR_LIST types the real devices use (doors, locks,
+chargers, smoothed power, temperature, 24h energy) and ends with the WiFi sensor,
+spread over the display sections. Entity ids are unique and sort in no particular
+SENSOR_LIST order, like real ones.
+"""
+import sys
+
+KINDS = [
+    ("SENSOR_BINARY", "door", "binary_sensor.bench_door_{n}", ""),
+    ("SENSOR_THRESHOLD_EMA", "circuit", "sensor.bench_circuit_{n}_power", ", 0.3, 0.5, 0.5, 120"),
+    ("SENSOR_TEXT_ENUM", "lock", "lock.bench_lock_{n}", ", LockState"),
+    ("SENSOR_THRESHOLD", "temp", "sensor.bench_temp_{n}", ", 1.0"),
+    ("SENSOR_PASSIVE", "energy", "sensor.bench_energy_{n}_last_24h", ""),
+    ("SENSOR_TEXT_ENUM_FILTERED", "charger", "sensor.bench_charger_{n}_status",
+     ", ChargerState, ChargerState::UNAVAILABLE"),
+    ("SENSOR_THRESHOLD_MEDIAN", "current", "sensor.bench_current_{n}", ", 3, 100.0, 100.0, 30"),
+]
+
+SECTIONS = ["SECTION_WEATHER", "SECTION_SOLAR_OUTPUT", "SECTION_SOLAR_24HR", "SECTION_HOME_24HR",
+            "SECTION_CHARGING", "SECTION_GATE1", "SECTION_GATE2", "SECTION_GATE3"]
+
+
+def main(count, out):
+    count = int(count)
+    if count < 2:
+        sys.exit("Need at least 2 sensors")
+    entries = []
+    for i in range(count - 1):
+        macro, name, entity, args = KINDS[i % len(KINDS)]
+        n = "%03d" % i
+        entries.append('  X(%s, %s_%s, %s, "%s %s", "%s"%s) \\'
+                       % (macro, name, n, SECTIONS[i % len(SECTIONS)], name.title(), n,
+                          entity.format(n=n), args))
+    entries.append('  X(SENSOR_WIFI, wifi_rssi, SECTION_WEATHER, "WiFi Signal", "wifisignal")')
+    lines = [
+        "// Generated by bench_list.py - synthetic %d-sensor SENSOR_LIST" % count,
+        "",
+        '#include "homink_sensor.h"',
+        '#include "homink_display.h"',
+        "",
+        "#define SENSOR_LIST(X) \\",
+    ] + entries + [
+        "",
+        "SENSOR_REGISTRY()",
+        "",
+        "#define SENSOR_STALENESS_ALL()",
+        "#define SENSOR_QUANTIZERS_ALL()",
+        "",
+    ]
+    with open(out, "w") as f:
+        f.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("Usage: bench_list.py count out_header")
+    main(*sys.argv[1:])
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Convert a Home Assistant history export into a replay fixture (ms,entity_id,state).
+
+Fetch the history with every state change, not just the significant ones:
+
+  curl -H "Authorization: Bearer $TOKEN" \
+    "http://homeassistant.local:8123/api/history/period/2026-10-01T07:00:00-07:00?end_time=2026-10-01T10:00:00-07:00&significant_changes_only=0&filter_entity_id=sun.sun,sensor.birgenshire_temp,..." \
+    > history.json
+  ./ha_history_to_csv.py history.json > fixtures/my-morning.csv
+
+Entities the device reads through an attribute take that attribute instead of the state.
+"""
+import json
+import sys
+from datetime import datetime
+
+ATTRIBUTES = {"sun.sun": "elevation"}
+
+
+def main(path):
+    with open(path) as f:
+        history = json.load(f)
+    rows = []
+    for series in history:
+        entity = series[0]["entity_id"] if series else None
+        for entry in series:
+            entity = entry.get("entity_id", entity)
+            stamp = entry.get("last_updated") or entry["last_changed"]
+            if entity in ATTRIBUTES:
+                state = entry.get("attributes", {}).get(ATTRIBUTES[entity])
+                if state is None:
+                    continue
+            else:
+                state = entry["state"]
+            rows.append((datetime.fromisoformat(stamp).timestamp(), entity, str(state)))
+    if not rows:
+        sys.exit("No states in " + path)
+    rows.sort()
+    start = rows[0][0]
+    print("# Recorded from " + path)
+    print("ms,entity_id,state")
+    for stamp, entity, state in rows:
+        print("%d,%s,%s" % (round((stamp - start) * 1000), entity, state))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.exit("Usage: ha_history_to_csv.py history.json > fixture.csv")
+    main(sys.argv[1])
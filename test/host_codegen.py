@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""The part of ESPHome's code generation the host renderer needs, for one device.
+
+  host_codegen.py ../homink-common.inc ../homink-entrance.yaml build/entrance
+
+writes into the output directory:
+  fonts.inc           one esphome::font::Font * per font: entry and its file, size and glyphs
+  display_lambda.inc  the display lambda body, substitutions applied, #line-mapped to the .inc
+
+Needs PyYAML (an ESPHome dependency).
+"""
+import os
+import re
+import sys
+
+import yaml
+
+
+class Loader(yaml.SafeLoader):
+    """Skips ESPHome tags (!include, !secret, !lambda) - only plain values are read."""
+
+
+Loader.add_multi_constructor("!", lambda loader, suffix, node: None)
+
+
+def load(path):
+    with open(path) as f:
+        return yaml.load(f, Loader=Loader)
+
+
+def substitute(text, substitutions):
+    def value(match):
+        name = match.group(1) or match.group(2)
+        if name not in substitutions:
+            sys.exit("Unknown substitution ${%s}" % name)
+        return str(substitutions[name])
+    return re.sub(r"\$\{(\w+)\}|\$(\w+)", value, text)
+
+
+def c_string(text):
+    # Octal escapes for every byte: always three digits, so no escape runs into the next character
+    return '"' + "".join("\\%03o" % b for b in text.encode("utf-8")) + '"'
+
+
+def write_fonts(config, substitutions, out):
+    lines = ["// Generated by host_codegen.py - font: entries of the device config", ""]
+    specs = []
+    for font in config["font"]:
+        glyphs = font["glyphs"]
+        if isinstance(glyphs, str):
+            glyphs = list(substitute(glyphs, substitutions))
+        glyphs = "".join(substitute(g, substitutions) for g in glyphs)
+        lines.append("esphome::font::Font *%s = nullptr;" % font["id"])
+        specs.append("  {&%s, \"%s\", \"%s\", %d, %s},"
+                     % (font["id"], font["id"], font["file"], font["size"], c_string(glyphs)))
+    lines += ["", "const host::FontSpec HOST_FONTS[] = {"] + specs + ["};", ""]
+    with open(os.path.join(out, "fonts.inc"), "w") as f:
+        f.write("\n".join(lines))
+
+
+def write_lambda(path, config, substitutions, out):
+    # Line of the lambda body in the .inc, so compiler errors point at the YAML
+    with open(path) as f:
+        source = f.read().splitlines()
+    start = source.index("display:")
+    first = next(i for i in range(start, len(source)) if source[i].strip() == "lambda: |-") + 2
+    body = substitute(config["display"][0]["lambda"], substitutions)
+    with open(os.path.join(out, "display_lambda.inc"), "w") as f:
+        f.write('#line %d "%s"\n%s\n' % (first, os.path.abspath(path), body))
+
+
+def main(common, device, out):
+    substitutions = load(device)["substitutions"]
+    config = load(common)
+    os.makedirs(out, exist_ok=True)
+    write_fonts(config, substitutions, out)
+    write_lambda(common, config, substitutions, out)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        sys.exit("Usage: host_codegen.py homink-common.inc homink-<device>.yaml out_dir")
+    main(*sys.argv[1:])
@@ -0,0 +1,116 @@
+// Host stand-in for the ESPHome main.cpp of one device: the ids the homink headers
+// and lambdas reach through id(), one mock component per SENSOR_LIST entry with its
+// on_value -> SENSOR_UPDATE_CALLBACK hook, and the on_boot steps.
+// Build with -DHOMINK_DEVICE_HEADER='"homink-entrance.h"' (see Makefile). Include it after
+// the standard headers - it defines id() as ESPHome's lambda rewrite would.
+#pragma once
+
+#include HOMINK_DEVICE_HEADER
+
+#include <cstdlib>
+#include <ctime>
+#include <type_traits>
+
+// ESPHome rewrites id(x) in lambdas; the host ids are plain variables
+#define id(x) x
+
+// Globals (homink-common.inc globals: block)
+bool data_updated = false;
+bool ha_connected = false;
+long last_ha_connection_time = 0;
+long last_display_refresh_time = 0;
+float tesla_power_factor = 0.789f;
+
+// time: homeassistant_time - wall clock follows host::clock_ms from a fixed epoch
+struct HostTime {
+  struct Now {
+    long timestamp;
+    int hour;
+  };
+  Now now() const {
+    time_t t = epoch + host::clock_ms / 1000;
+    struct tm local;
+    localtime_r(&t, &local);
+    return {static_cast<long>(t), local.tm_hour};
+  }
+  time_t epoch{1790863200};  // 2026-10-01 07:00 PDT
+} homeassistant_time;
+
+// script: mode single - execute() while running is ignored
+struct HostScript {
+  void execute() {
+    if (running) return;
+    running = true;
+    started_ms = host::clock_ms;
+    runs++;
+  }
+  bool is_running() const { return running; }
+  void stop() { running = false; }
+
+  bool running{false};
+  uint32_t started_ms{0};
+  uint32_t runs{0};
+};
+HostScript schedule_refresh;
+HostScript update_screen;
+
+namespace host {
+
+// The ESPHome component type a sensor reads (BaseSensor's SensorType)
+template<typename D, typename V, typename S> S *component_of(BaseSensor<D, V, S> &);
+template<typename Sensor> using component_t = std::remove_pointer_t<decltype(component_of(std::declval<Sensor &>()))>;
+
+// Publish an HA state string the way the homeassistant components parse it
+inline void publish_text(esphome::sensor::Sensor &s, const char *text) {
+  char *end;
+  float value = std::strtof(text, &end);
+  s.publish_state(end == text ? NAN : value);  // "unavailable" -> NAN, like the HA sensor
+}
+inline void publish_text(esphome::binary_sensor::BinarySensor &s, const char *text) {
+  if (std::strcmp(text, "on") == 0 || std::strcmp(text, "off") == 0) {
+    s.publish_state(text[1] == 'n');
+  } else {
+    s.invalidate_state();
+  }
+}
+inline void publish_text(esphome::text_sensor::TextSensor &s, const char *text) { s.publish_state(text); }
+
+using Publisher = void (*)(const char *state);
+
+}  // namespace host
+
+// One component per sensor (id: _var in the YAML)
+#define HOST_COMPONENT(type, var, sections, ...) HOST_COMPONENT_(var)
+#define HOST_COMPONENT_(var) host::component_t<decltype(var)> _##var;
+SENSOR_LIST(HOST_COMPONENT)
+
+// SENSOR_LIST order = slot order, so HOST_PUBLISHERS[slot] feeds that sensor's component
+#define HOST_PUBLISHER(type, var, sections, ...) HOST_PUBLISHER_(var)
+#define HOST_PUBLISHER_(var) [](const char *state) { host::publish_text(_##var, state); },
+const host::Publisher HOST_PUBLISHERS[] = {SENSOR_LIST(HOST_PUBLISHER)};
+
+// Sensor variable names by slot - the same on every device, unlike names and entity_ids
+#define HOST_VAR(type, var, sections, ...) HOST_VAR_(var)
+#define HOST_VAR_(var) #var,
+const char *const HOST_VARS[] = {SENSOR_LIST(HOST_VAR)};
+
+// Forget a component's state (never received, or the entity went away)
+#define HOST_INVALIDATOR(type, var, sections, ...) HOST_INVALIDATOR_(var)
+#define HOST_INVALIDATOR_(var) [](const char *) { _##var.invalidate_state(); },
+const host::Publisher HOST_INVALIDATORS[] = {SENSOR_LIST(HOST_INVALIDATOR)};
+
+#define HOST_HOOK(type, var, sections, ...) HOST_HOOK_(var)
+#define HOST_HOOK_(var) _##var.add_on_state_callback([](const auto &) { SENSOR_UPDATE_CALLBACK(var); });
+
+namespace host {
+
+// on_boot: link the sensors, per-sensor budgets and quantizers from the device header
+inline void boot(uint32_t stale_after_s) {
+  SENSOR_INIT_ALL();
+  SENSOR_LIST(HOST_HOOK)
+  Sensors::set_default_stale_after(stale_after_s);
+  SENSOR_STALENESS_ALL();
+  SENSOR_QUANTIZERS_ALL();
+}
+
+}  // namespace host
@@ -0,0 +1,374 @@
+// Host mock of the ESPHome API subset the homink headers and the display lambda use
+// (test/ builds only). millis() is the replay clock - host::clock_ms, advanced by the
+// test - so staleness, hold times and BUSY waits follow the recorded timestamps.
+// micros() is the host's steady clock, so the timed paths report real host time.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace host {
+inline uint32_t clock_ms = 0;
+inline int log_level = 2;  // 1 error, 2 warning, 3 info, 4 debug, 5 verbose
+
+__attribute__((format(printf, 3, 4))) inline void log(int level, const char *tag, const char *format, ...) {
+  if (level > log_level) return;
+  std::fprintf(stderr, "[%c][%s] ", "?EWIDV"[level], tag);
+  va_list args;
+  va_start(args, format);
+  std::vfprintf(stderr, format, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+}
+}  // namespace host
+
+#define ESP_LOGE(tag, ...) host::log(1, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) host::log(2, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) host::log(3, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) host::log(4, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) host::log(5, tag, __VA_ARGS__)
+#define HOT
+
+inline uint32_t millis() { return host::clock_ms; }
+inline void delay(uint32_t ms) { host::clock_ms += ms; }
+inline uint32_t micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+namespace esphome {
+
+struct Application {
+  void feed_wdt() {}
+};
+inline Application App;
+
+class GPIOPin {
+public:
+  bool digital_read() { return level; }
+  void digital_write(bool value) { level = value; }
+  bool level{false};
+};
+
+struct Color {
+  uint8_t r{0}, g{0}, b{0}, w{0};
+  bool is_on() const { return r || g || b || w; }
+};
+inline const Color COLOR_ON{255, 255, 255, 255};
+inline const Color COLOR_OFF{};
+
+// State and on_value callbacks of the sensor components
+template<typename T>
+class StateComponent {
+public:
+  T state{};
+  bool has_state() const { return _has_state; }
+  void publish_state(const T &value) {
+    state = value;
+    _has_state = true;
+    notify_();
+  }
+  void invalidate_state() {
+    _has_state = false;
+    notify_();
+  }
+  void add_on_state_callback(std::function<void(const T &)> &&callback) { _callbacks.push_back(std::move(callback)); }
+
+private:
+  void notify_() {
+    for (auto &callback : _callbacks) callback(state);
+  }
+  std::vector<std::function<void(const T &)>> _callbacks;
+  bool _has_state{false};
+};
+
+namespace sensor { class Sensor : public StateComponent<float> {}; }
+namespace text_sensor { class TextSensor : public StateComponent<std::string> {}; }
+namespace binary_sensor { class BinarySensor : public StateComponent<bool> {}; }
+namespace homeassistant {
+class HomeassistantSensor : public sensor::Sensor {};
+class HomeassistantTextSensor : public text_sensor::TextSensor {};
+class HomeassistantBinarySensor : public binary_sensor::BinarySensor {};
+}  // namespace homeassistant
+namespace wifi_signal { class WiFiSignalSensor : public sensor::Sensor {}; }
+
+// Preferences kept in memory, keyed like NVS by the preference hash
+struct ESPPreferenceObject {
+  std::vector<uint8_t> *slot{nullptr};
+  template<typename T> bool save(const T *src) {
+    slot->assign(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<const uint8_t *>(src) + sizeof(T));
+    return true;
+  }
+  template<typename T> bool load(T *dst) {
+    if (slot->size() != sizeof(T)) return false;
+    std::memcpy(static_cast<void *>(dst), slot->data(), sizeof(T));
+    return true;
+  }
+};
+struct ESPPreferences {
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool = false) { return {&store[type]}; }
+  bool sync() { return true; }
+  std::map<uint32_t, std::vector<uint8_t>> store;
+};
+inline ESPPreferences host_preferences;
+inline ESPPreferences *global_preferences = &host_preferences;
+
+template<class T>
+class ExternalRAMAllocator {
+public:
+  enum Flags { NONE = 0, REFUSE_INTERNAL = 1, ALLOW_FAILURE = 2 };
+  explicit ExternalRAMAllocator(Flags) {}
+  T *allocate(size_t n) { return new T[n]; }
+  void deallocate(T *p, size_t) { delete[] p; }
+};
+
+namespace font {
+// Glyph bitmaps are row-major bitstreams without row padding, MSB first (bpp 1)
+struct GlyphData {
+  const uint8_t *a_char;  // UTF-8 sequence
+  const uint8_t *data;
+  int advance, offset_x, offset_y, width, height;
+};
+
+class Glyph {
+public:
+  explicit Glyph(const GlyphData *data) : _data(data) {}
+  const GlyphData *get_glyph_data() const { return _data; }
+
+private:
+  const GlyphData *_data;
+};
+
+class Font {
+public:
+  Font(std::vector<Glyph> glyphs, int baseline, int height) : _glyphs(std::move(glyphs)), _baseline(baseline), _height(height) {}
+
+  int match_next_glyph(const uint8_t *str, int *match_length) const {
+    for (size_t i = 0; i < _glyphs.size(); i++) {
+      const char *c = reinterpret_cast<const char *>(_glyphs[i].get_glyph_data()->a_char);
+      size_t n = std::strlen(c);
+      if (std::strncmp(reinterpret_cast<const char *>(str), c, n) == 0) {
+        *match_length = static_cast<int>(n);
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  // Same metrics as esphome::font::Font::measure()
+  void measure(const char *str, int *width, int *x_offset, int *baseline, int *height) const {
+    *baseline = _baseline;
+    *height = _height;
+    int x = 0, min_x = 0;
+    bool first = true;
+    for (const uint8_t *p = reinterpret_cast<const uint8_t *>(str); *p;) {
+      int length = 1;
+      int n = match_next_glyph(p, &length);
+      if (n < 0) {
+        if (!_glyphs.empty()) x += _glyphs[0].get_glyph_data()->width;
+        p++;
+        continue;
+      }
+      const GlyphData *g = _glyphs[n].get_glyph_data();
+      min_x = first ? g->offset_x : std::min(min_x, x + g->offset_x);
+      first = false;
+      x += g->advance;
+      p += length;
+    }
+    *x_offset = min_x;
+    *width = x - min_x;
+  }
+
+  int get_bpp() const { return 1; }
+  int get_height() const { return _height; }
+  const std::vector<Glyph> &get_glyphs() const { return _glyphs; }
+
+private:
+  std::vector<Glyph> _glyphs;
+  int _baseline, _height;
+};
+}  // namespace font
+
+namespace display {
+enum DisplayRotation { DISPLAY_ROTATION_0_DEGREES = 0, DISPLAY_ROTATION_90_DEGREES = 90 };
+enum class TextAlign {
+  TOP = 0x00, CENTER_VERTICAL = 0x01, BASELINE = 0x02, BOTTOM = 0x04,
+  LEFT = 0x00, CENTER_HORIZONTAL = 0x08, RIGHT = 0x10,
+  TOP_LEFT = 0x00, TOP_CENTER = 0x08, TOP_RIGHT = 0x10,
+  CENTER_LEFT = 0x01, CENTER = 0x09, CENTER_RIGHT = 0x11,
+  BASELINE_LEFT = 0x02, BASELINE_CENTER = 0x0A, BASELINE_RIGHT = 0x12,
+  BOTTOM_LEFT = 0x04, BOTTOM_CENTER = 0x0C, BOTTOM_RIGHT = 0x14,
+};
+
+class Display {
+public:
+  virtual ~Display() = default;
+
+  void set_writer(std::function<void(Display &)> writer) { _writer = std::move(writer); }
+  void set_rotation(DisplayRotation rotation) { _rotation = rotation; }
+  DisplayRotation get_rotation() const { return _rotation; }
+  void set_auto_clear(bool enabled) { auto_clear_enabled_ = enabled; }
+
+  virtual void fill(Color color) = 0;
+  void clear() { fill(COLOR_OFF); }
+
+  void draw_pixel_at(int x, int y, Color color) {
+    if (_rotation == DISPLAY_ROTATION_90_DEGREES) {
+      std::swap(x, y);
+      x = get_width_internal() - x - 1;
+    }
+    draw_absolute_pixel_internal(x, y, color);
+  }
+
+  // Bresenham, as esphome::display::Display::line()
+  void line(int x1, int y1, int x2, int y2, Color color) {
+    int dx = std::abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -std::abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+      draw_pixel_at(x1, y1, color);
+      if (x1 == x2 && y1 == y2) break;
+      int e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x1 += sx; }
+      if (e2 <= dx) { err += dx; y1 += sy; }
+    }
+  }
+
+  void get_text_bounds(int x, int y, const char *text, font::Font *font, TextAlign align,
+                       int *x1, int *y1, int *width, int *height) {
+    int x_offset, baseline;
+    font->measure(text, width, &x_offset, &baseline, height);
+    int h = int(align) & 0x18, v = int(align) & 0x07;
+    *x1 = h == int(TextAlign::RIGHT) ? x - *width : h == int(TextAlign::CENTER_HORIZONTAL) ? x - (*width + x_offset) / 2 : x;
+    *y1 = v == int(TextAlign::BOTTOM) ? y - *height : v == int(TextAlign::BASELINE) ? y - baseline
+        : v == int(TextAlign::CENTER_VERTICAL) ? y - *height / 2 : y;
+  }
+
+  // esphome::font::Font::print() for bpp 1 (a missing glyph draws a box)
+  void print(int x, int y, font::Font *font, Color color, TextAlign align, const char *text) {
+    int x_at, y_top, width, height;
+    get_text_bounds(x, y, text, font, align, &x_at, &y_top, &width, &height);
+    for (const uint8_t *p = reinterpret_cast<const uint8_t *>(text); *p;) {
+      int length = 1;
+      int n = font->match_next_glyph(p, &length);
+      if (n < 0) {
+        if (font->get_glyphs().empty()) break;
+        int w = font->get_glyphs()[0].get_glyph_data()->width;
+        for (int i = 0; i < w * font->get_height(); i++) draw_pixel_at(x_at + i % w, y_top + i / w, color);
+        x_at += w;
+        p++;
+        continue;
+      }
+      const font::GlyphData *g = font->get_glyphs()[n].get_glyph_data();
+      for (int bit = 0; bit < g->width * g->height; bit++) {
+        if (g->data[bit / 8] & (0x80 >> (bit % 8))) {
+          draw_pixel_at(x_at + g->offset_x + bit % g->width, y_top + g->offset_y + bit / g->width, color);
+        }
+      }
+      x_at += g->advance;
+      p += length;
+    }
+  }
+
+protected:
+  virtual void draw_absolute_pixel_internal(int x, int y, Color color) = 0;
+  virtual int get_width_internal() = 0;
+  virtual int get_height_internal() = 0;
+
+  void do_update_() {
+    if (auto_clear_enabled_) clear();
+    if (_writer) _writer(*this);
+  }
+
+  bool auto_clear_enabled_{true};
+
+private:
+  std::function<void(Display &)> _writer;
+  DisplayRotation _rotation{DISPLAY_ROTATION_0_DEGREES};
+};
+
+class DisplayBuffer : public Display {
+protected:
+  uint8_t *buffer_{nullptr};
+};
+}  // namespace display
+
+namespace spi {
+class SPIDevice {
+public:
+  void enable() {}
+  void disable() {}
+  void write_byte(uint8_t) { bytes_written++; }
+  void write_array(const uint8_t *, size_t length) { bytes_written += length; }
+  uint64_t bytes_written{0};
+};
+}  // namespace spi
+
+namespace waveshare_epaper {
+class WaveshareEPaperBase : public display::DisplayBuffer, public spi::SPIDevice {
+public:
+  void command(uint8_t) {}
+  void data(uint8_t) {}
+  virtual void display() = 0;
+  virtual void initialize() = 0;
+  virtual void deep_sleep() = 0;
+
+  // Stock buffer polarity: COLOR_ON clears the bit, clear() fills with 0xFF
+  void fill(Color color) override { std::memset(buffer_, color.is_on() ? 0x00 : 0xFF, get_buffer_length_()); }
+
+protected:
+  void draw_absolute_pixel_internal(int x, int y, Color color) override {
+    if (x < 0 || y < 0 || x >= get_width_internal() || y >= get_height_internal()) return;
+    uint8_t &byte = buffer_[(x + y * get_width_internal()) / 8];
+    uint8_t mask = 0x80 >> (x & 7);
+    byte = color.is_on() ? byte & ~mask : byte | mask;
+  }
+  virtual uint32_t get_buffer_length_() = 0;
+  void reset_() {}
+  void start_data_() {}
+  void end_data_() {}
+
+  GPIOPin *reset_pin_{nullptr};
+  GPIOPin *dc_pin_{nullptr};
+  GPIOPin *busy_pin_{nullptr};
+};
+
+class WaveshareEPaper : public WaveshareEPaperBase {};
+
+// model: 7.50inv2 - 800x480 native, the BUSY pin reads idle
+class WaveshareEPaper7P5InV2 : public WaveshareEPaper {
+public:
+  WaveshareEPaper7P5InV2() {
+    buffer_ = _frame.data();
+    busy_pin_ = &_busy;
+  }
+  void display() override {}
+  void initialize() override {}
+  void deep_sleep() override {}
+  const uint8_t *frame() const { return _frame.data(); }
+
+protected:
+  int get_width_internal() override { return 800; }
+  int get_height_internal() override { return 480; }
+  uint32_t get_buffer_length_() override { return 800 * 480 / 8; }
+
+private:
+  std::vector<uint8_t> _frame = std::vector<uint8_t>(800 * 480 / 8, 0xFF);
+  GPIOPin _busy;
+};
+}  // namespace waveshare_epaper
+
+}  // namespace esphome
+
+using namespace esphome;
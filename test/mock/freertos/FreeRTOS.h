@@ -0,0 +1,5 @@
+// Host mock: the FreeRTOS types homink_diag.h uses
+#pragma once
+
+typedef unsigned int UBaseType_t;
+typedef void *TaskHandle_t;
@@ -0,0 +1,6 @@
+// Host mock: no task stacks on the host - the high-water mark reads 0
+#pragma once
+
+#include "FreeRTOS.h"
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
@@ -0,0 +1,116 @@
+// DisplayQuantizer against the display lambda's formatting, at the rounding boundaries.
+//
+//   build/quantize-entrance
+//
+// For the quantizers of the device's SENSOR_QUANTIZERS_ALL(): every pair of neighbouring
+// values around each .5 (whole °F) and .x5 (0.1 kW) boundary must compare equal exactly
+// when the lambda's own printf prints the same text. Then the temperature stream
+// 72.4 -> 72.5 -> 72.6 goes through SENSOR_UPDATE_CALLBACK: printed "72", "72", "73",
+// so only the last push may trigger. Exit status 1 on any mismatch.
+
+#include <cmath>
+#include <string>
+
+#include "host_device.h"  // Last: defines id()
+
+namespace {
+
+int failures = 0;
+
+void expect(bool ok, const char *what) {
+  if (!ok) {
+    failures++;
+    std::printf("FAIL %s\n", what);
+  }
+}
+
+// The display lambda's expressions (homink-common.inc, ENERGY / WEATHER sections)
+std::string temperature_text(float v) {
+  char buf[32];
+  if (v >= 100 || v <= -10) {
+    std::snprintf(buf, sizeof(buf), "%.0f°F", v);
+  } else {
+    std::snprintf(buf, sizeof(buf), "%2.0f°F", v);
+  }
+  return buf;
+}
+
+std::string solar_text(float v) {
+  char buf[32];
+  float current_solar = v < 0 ? 0.0 : v;
+  std::snprintf(buf, sizeof(buf), "%.1f kW", current_solar);
+  return buf;
+}
+
+std::string charging_text(float v) {
+  if (!(v > 100.0)) return "idle";
+  char buf[32];
+  float real_power_kw = (v * tesla_power_factor) / 1000.0;
+  std::snprintf(buf, sizeof(buf), "%.1f kW", real_power_kw);
+  return buf;
+}
+
+// Neighbouring float pairs straddling boundary b: a few ulps below, at and above it
+template<typename Text>
+void check_boundary(const char *name, const DisplayQuantizer &q, Text &&text, float b) {
+  float values[7];
+  float v = b;
+  for (int i = 0; i < 3; i++) v = std::nextafter(v, -INFINITY);
+  for (float &value : values) {
+    value = v;
+    v = std::nextafter(v, INFINITY);
+  }
+  for (float a : values) {
+    for (float c : values) {
+      if (q.same_text(a, c) != (text(a) == text(c))) {
+        char what[160];
+        std::snprintf(what, sizeof(what), "%s: %.9g vs %.9g quantized %s, printed \"%s\" / \"%s\"", name, a, c,
+                      q.same_text(a, c) ? "same" : "different", text(a).c_str(), text(c).c_str());
+        expect(false, what);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  host::boot(60);
+
+  const DisplayQuantizer &temp_q = temperature.quantizer();
+  const DisplayQuantizer &solar_q = solar_power.quantizer();
+  const DisplayQuantizer &charging_q = charging_power.quantizer();
+  expect(temp_q.enabled() && solar_q.enabled() && charging_q.enabled(), "quantizers configured");
+
+  for (int i = -200; i <= 2400; i++) {
+    check_boundary("temperature", temp_q, temperature_text, i * 0.05f);  // .5 and every .x5
+  }
+  for (int i = -20; i <= 2000; i++) {
+    check_boundary("solar", solar_q, solar_text, i * 0.005f);  // .x5 and .x0
+  }
+  for (int i = 0; i <= 20000; i++) {
+    float kw = i * 0.005f;
+    check_boundary("charging", charging_q, charging_text, kw * 1000.0f / tesla_power_factor);
+  }
+  check_boundary("charging idle", charging_q, charging_text, 100.0f);
+
+  expect(temp_q.same_text(72.4f, 72.5f), "72.4 and 72.5 both print 72");
+  expect(!temp_q.same_text(72.5f, 72.6f), "72.5 prints 72, 72.6 prints 73");
+  expect(solar_q.same_text(0.2f, 0.25f), "0.25 prints 0.2");
+  expect(!solar_q.same_text(0.25f, 0.26f), "0.26 prints 0.3");
+
+  // Through the push path: only the push that changes the printed text triggers
+  uint32_t triggers[3];
+  const float stream[3] = {72.4f, 72.5f, 72.6f};
+  for (int i = 0; i < 3; i++) {
+    _temperature.publish_state(stream[i]);
+    triggers[i] = temperature.triggers();
+    Sensors::take_dirty();
+    Sensors::update_all();
+  }
+  expect(triggers[1] == triggers[0], "72.4 -> 72.5 does not trigger");
+  expect(triggers[2] == triggers[1] + 1, "72.5 -> 72.6 triggers");
+
+  std::printf("%s: %d failure(s)\n", failures ? "FAIL" : "OK", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,444 @@
+// Host renderer: the display lambda of homink-common.inc drawn on the mock 7.50inv2
+// framebuffer (480x800 portrait, 1bpp) through the real eink_panel and eink_text, with
+// the device's font: entries rasterized by FreeType the way ESPHome's font component
+// builds them (monochrome, same glyph metrics).
+//
+//   build/render-entrance [-o out_dir] [-n renders] [-f repo_dir] [-v]
+//
+// Every scenario of the state matrix is published through the sensor components and
+// refreshed like update_screen: take_dirty + update_all, eink_panel.begin(), poll() until
+// done. Each frame is then rendered n - 1 more times (unchanged frame, transfer skipped)
+// for the render time. Writes per scenario:
+//   NN-name.png       the frame as the panel shows it
+//   NN-name-diff.png  against the previous frame: red turned black, blue turned white,
+//                     grey unchanged ink, yellow the bands of the sections pushed
+// and prints the refresh result, render time and the changed pixels per section.
+// Ink outside every section band is reported too: partial refreshes never push it.
+#include <cerrno>
+#include <cmath>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <memory>
+#include <png.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "host_device.h"  // Last: defines id()
+
+namespace host {
+
+// One font: entry of the device config (generated fonts.inc)
+struct FontSpec {
+  esphome::font::Font **font;
+  const char *id;
+  const char *file;
+  int size;
+  const char *glyphs;  // UTF-8, one glyph per code point
+};
+
+}  // namespace host
+
+#include "fonts.inc"
+
+// ESPHome's generated main.cpp: colors, the display component, and the lambda as a writer
+esphome::Color color_bg{0, 0, 0, 0};
+esphome::Color color_text{0, 0, 0, 255};
+esphome::waveshare_epaper::WaveshareEPaper7P5InV2 host_panel;
+esphome::waveshare_epaper::WaveshareEPaper7P5InV2 *eink_display = &host_panel;
+
+using namespace esphome::display;
+
+void display_lambda(Display &it) {
+#include "display_lambda.inc"
+}
+
+namespace {
+
+constexpr int WIDTH = homink_layout::DISPLAY_WIDTH;
+constexpr int HEIGHT = homink_layout::DISPLAY_HEIGHT;
+using Canvas = std::vector<uint8_t>;  // Portrait, row-major, 1 = ink
+
+// ---------------------------------------------------------------------------
+// Fonts
+// ---------------------------------------------------------------------------
+
+struct HostFont {
+  std::vector<std::string> chars;  // GlyphData::a_char
+  std::vector<std::vector<uint8_t>> bitmaps;
+  std::vector<esphome::font::GlyphData> data;
+  std::unique_ptr<esphome::font::Font> font;
+};
+std::vector<std::unique_ptr<HostFont>> host_fonts;
+
+uint32_t decode_utf8(const std::string &s) {
+  const auto *p = reinterpret_cast<const uint8_t *>(s.data());
+  int n = utf8_length(p[0]);
+  uint32_t cp = n == 1 ? p[0] : p[0] & (0x7F >> n);
+  for (int i = 1; i < n; i++) cp = cp << 6 | (p[i] & 0x3F);
+  return cp;
+}
+
+// ESPHome: set_pixel_sizes(size), FT_LOAD_TARGET_MONO for bpp 1, baseline = ascender,
+// offset_y = baseline - bitmap_top, glyphs sorted by code point, bitmaps packed without
+// row padding
+bool load_font(FT_Library library, const std::string &root, const host::FontSpec &spec) {
+  std::string path = root + "/" + spec.file;
+  FT_Face face;
+  if (FT_New_Face(library, path.c_str(), 0, &face)) {
+    std::fprintf(stderr, "%s: cannot open %s\n", spec.id, path.c_str());
+    return false;
+  }
+  FT_Set_Pixel_Sizes(face, spec.size, 0);
+  int baseline = face->size->metrics.ascender / 64;
+  int height = face->size->metrics.height / 64;
+
+  auto font = std::make_unique<HostFont>();
+  for (const char *p = spec.glyphs; *p; p += utf8_length(static_cast<uint8_t>(*p))) {
+    font->chars.emplace_back(p, utf8_length(static_cast<uint8_t>(*p)));
+  }
+  std::sort(font->chars.begin(), font->chars.end());
+  font->chars.erase(std::unique(font->chars.begin(), font->chars.end()), font->chars.end());
+  font->bitmaps.resize(font->chars.size());
+
+  bool ok = true;
+  for (size_t i = 0; i < font->chars.size(); i++) {
+    uint32_t cp = decode_utf8(font->chars[i]);
+    if (!FT_Get_Char_Index(face, cp) || FT_Load_Char(face, cp, FT_LOAD_RENDER | FT_LOAD_TARGET_MONO)) {
+      std::fprintf(stderr, "%s: %s has no glyph U+%04X\n", spec.id, spec.file, (unsigned) cp);
+      ok = false;
+      continue;
+    }
+    const FT_GlyphSlot slot = face->glyph;
+    const FT_Bitmap &bitmap = slot->bitmap;
+    int w = bitmap.width, h = bitmap.rows;
+    std::vector<uint8_t> &bits = font->bitmaps[i];
+    bits.assign((w * h + 7) / 8, 0);
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        if (bitmap.buffer[y * bitmap.pitch + x / 8] & (0x80 >> (x % 8))) {
+          int bit = y * w + x;
+          bits[bit / 8] |= 0x80 >> (bit % 8);
+        }
+      }
+    }
+    font->data.push_back({reinterpret_cast<const uint8_t *>(font->chars[i].c_str()), bits.data(),
+                          static_cast<int>(slot->metrics.horiAdvance / 64), slot->bitmap_left,
+                          baseline - slot->bitmap_top, w, h});
+  }
+  FT_Done_Face(face);
+  if (!ok) return false;
+
+  std::vector<esphome::font::Glyph> glyphs;
+  for (const auto &data : font->data) glyphs.emplace_back(&data);
+  font->font = std::make_unique<esphome::font::Font>(std::move(glyphs), baseline, height);
+  *spec.font = font->font.get();
+  host_fonts.push_back(std::move(font));
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// State matrix
+// ---------------------------------------------------------------------------
+
+struct State {
+  const char *var;
+  const char *state;  // As HA pushes it; nullptr = no state (never received)
+};
+
+struct Scenario {
+  const char *name;
+  const char *clock;  // HH:MM on 2026-10-01 - keep ascending, millis() must not go back
+  bool ha_connected;
+  std::vector<State> changes;  // On top of the previous scenario, so each transition is one event
+};
+
+// Starts from a boot without any state
+const Scenario SCENARIOS[] = {
+  {"boot", "07:00", false, {}},
+  {"day", "09:30", true,
+   {{"gate1", "off"}, {"gate2", "off"}, {"gate3", "off"}, {"lock", "locked"},
+    {"weather", "partlycloudy"}, {"charger", "not_connected"}, {"temperature", "64.4"},
+    {"solar_power", "3.84"}, {"charging_power", "0.0"}, {"sun_elev", "38.5"},
+    {"solar_energy", "21.6"}, {"home_consumption", "18.2"}, {"wifi_rssi", "-58"}}},
+  {"plugged-in", "10:02", true, {{"charger", "connected"}}},
+  {"charging", "10:05", true, {{"charger", "charging"}, {"charging_power", "7420"}}},
+  {"gates-open", "12:10", true, {{"gate1", "on"}, {"gate2", "on"}}},
+  {"gates-closed", "12:12", true, {{"gate1", "off"}, {"gate2", "off"}}},
+  {"shed-unlocked", "12:30", true, {{"lock", "unlocked"}}},
+  {"shed-open", "12:31", true, {{"gate3", "on"}}},
+  {"shed-locked", "12:40", true, {{"gate3", "off"}, {"lock", "locked"}}},
+  {"charged", "13:20", true, {{"charger", "charging_finished"}, {"charging_power", "0.0"}}},
+  {"sunset", "18:40", true, {{"weather", "sunny"}, {"sun_elev", "2.1"}, {"solar_power", "0.41"}}},
+  {"night", "22:15", true, {{"sun_elev", "-18.2"}, {"solar_power", "0.0"}}},
+  {"night-cloudy", "22:20", true, {{"weather", "partlycloudy"}}},
+  {"unavailable", "22:30", true,
+   {{"temperature", "unavailable"}, {"weather", "unavailable"}, {"charger", "unavailable"},
+    {"gate2", "unavailable"}, {"wifi_rssi", nullptr}}},
+  {"ha-lost", "22:45", false, {}},
+  {"reconnected", "23:00", true,
+   {{"temperature", "58.1"}, {"weather", "cloudy"}, {"gate2", "off"}, {"wifi_rssi", "-64"}}},
+  {"charger-fault", "23:05", true, {{"charger", "error"}}},
+  {"extremes", "23:10", true,
+   {{"temperature", "104.2"}, {"solar_power", "-0.3"}, {"charger", "charging"}, {"charging_power", "11500"},
+    {"solar_energy", "123.4"}, {"home_consumption", "99.6"}, {"wifi_rssi", "-82"}}},
+};
+
+int slot_of(const char *var) {
+  for (int slot = 0; slot < Sensors::COUNT; slot++) {
+    if (std::strcmp(HOST_VARS[slot], var) == 0) return slot;
+  }
+  std::fprintf(stderr, "Unknown sensor %s\n", var);
+  std::exit(1);
+}
+
+// Publish the changed states through the components. Numeric states are pushed repeatedly
+// so the smoothing filters (EMA, median) settle on them, as after a steady stretch.
+void apply(const Scenario &scenario) {
+  for (const State &s : scenario.changes) {
+    int slot = slot_of(s.var);
+    if (!s.state) {
+      HOST_INVALIDATORS[slot](nullptr);
+      continue;
+    }
+    for (int i = 0; i < 20; i++) HOST_PUBLISHERS[slot](s.state);
+  }
+}
+
+uint32_t clock_of(const char *hhmm) {
+  int minutes = std::atoi(hhmm) * 60 + std::atoi(hhmm + 3) - 7 * 60;  // homeassistant_time epoch is 07:00
+  return static_cast<uint32_t>(minutes) * 60000;
+}
+
+// ---------------------------------------------------------------------------
+// Frames
+// ---------------------------------------------------------------------------
+
+// Portrait (x, y) is native (799 - y, x); a set bit is blank (stock polarity)
+Canvas capture() {
+  const uint8_t *frame = host_panel.frame();
+  Canvas canvas(WIDTH * HEIGHT);
+  for (int y = 0; y < HEIGHT; y++) {
+    int nx = HEIGHT - 1 - y;
+    for (int x = 0; x < WIDTH; x++) {
+      canvas[y * WIDTH + x] = !(frame[(x * HEIGHT + nx) / 8] & (0x80 >> (nx & 7)));
+    }
+  }
+  return canvas;
+}
+
+bool write_png(const std::string &path, int color_type, int depth, const std::vector<uint8_t> &rows, int row_bytes) {
+  FILE *f = std::fopen(path.c_str(), "wb");
+  if (!f) {
+    std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+    return false;
+  }
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  png_infop info = png_create_info_struct(png);
+  if (setjmp(png_jmpbuf(png))) {
+    png_destroy_write_struct(&png, &info);
+    std::fclose(f);
+    return false;
+  }
+  png_init_io(png, f);
+  png_set_IHDR(png, info, WIDTH, HEIGHT, depth, color_type, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+               PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+  for (int y = 0; y < HEIGHT; y++) png_write_row(png, rows.data() + y * row_bytes);
+  png_write_end(png, nullptr);
+  png_destroy_write_struct(&png, &info);
+  std::fclose(f);
+  return true;
+}
+
+// 1bpp greyscale, white paper
+bool write_frame(const std::string &path, const Canvas &canvas) {
+  constexpr int ROW = WIDTH / 8;
+  std::vector<uint8_t> rows(ROW * HEIGHT, 0xFF);
+  for (int i = 0; i < WIDTH * HEIGHT; i++) {
+    if (canvas[i]) rows[i / 8] &= ~(0x80 >> (i % 8));
+  }
+  return write_png(path, PNG_COLOR_TYPE_GRAY, 1, rows, ROW);
+}
+
+bool write_diff(const std::string &path, const Canvas &before, const Canvas &after, uint32_t pushed) {
+  bool band[HEIGHT] = {};
+  for (const SectionBand &b : SECTION_BANDS) {
+    if (!(pushed & b.section)) continue;
+    for (int y = std::max(0, b.y_min); y < std::min(HEIGHT, b.y_max); y++) band[y] = true;
+  }
+  std::vector<uint8_t> rows(WIDTH * 3 * HEIGHT);
+  for (int i = 0; i < WIDTH * HEIGHT; i++) {
+    uint8_t *px = &rows[i * 3];
+    if (before[i] != after[i]) {
+      const uint8_t turned_black[3] = {220, 0, 0}, turned_white[3] = {0, 90, 255};
+      std::memcpy(px, after[i] ? turned_black : turned_white, 3);
+    } else if (after[i]) {
+      px[0] = px[1] = px[2] = 150;
+    } else if (band[i / WIDTH]) {
+      px[0] = 255, px[1] = 244, px[2] = 190;
+    } else {
+      px[0] = px[1] = px[2] = 255;
+    }
+  }
+  return write_png(path, PNG_COLOR_TYPE_RGB, 8, rows, WIDTH * 3);
+}
+
+const char *result_name(PanelRefresh::Result result) {
+  switch (result) {
+    case PanelRefresh::Result::FULL: return "FULL";
+    case PanelRefresh::Result::PARTIAL: return "PARTIAL";
+    default: return "SKIPPED";
+  }
+}
+
+// Changed pixels per section band and outside every band, with their bounding box
+void report_diff(const Canvas &before, const Canvas &after, bool first) {
+  uint32_t per_band[SECTION_COUNT] = {};
+  uint32_t total = 0, unbanded = 0;
+  int x_min = WIDTH, x_max = -1, y_min = HEIGHT, y_max = -1;
+  for (int y = 0; y < HEIGHT; y++) {
+    int band = -1;
+    for (int b = 0; b < SECTION_COUNT; b++) {
+      if (y >= SECTION_BANDS[b].y_min && y < SECTION_BANDS[b].y_max) band = b;
+    }
+    for (int x = 0; x < WIDTH; x++) {
+      if (before[y * WIDTH + x] == after[y * WIDTH + x]) continue;
+      total++;
+      band < 0 ? unbanded++ : per_band[band]++;
+      x_min = std::min(x_min, x), x_max = std::max(x_max, x);
+      y_min = std::min(y_min, y), y_max = std::max(y_max, y);
+    }
+  }
+  if (!total) {
+    std::printf("    no pixels changed\n");
+    return;
+  }
+  std::printf("    %u pixels changed in x %d-%d, y %d-%d:", (unsigned) total, x_min, x_max, y_min, y_max);
+  const char *separator = " ";
+  for (int b = 0; b < SECTION_COUNT; b++) {
+    if (!per_band[b]) continue;
+    std::printf("%s%s %u", separator, SECTION_BANDS[b].name, (unsigned) per_band[b]);
+    separator = ", ";
+  }
+  std::printf("\n");
+  if (unbanded && !first) std::printf("    WARNING: %u changed pixels outside every section band\n", (unsigned) unbanded);
+}
+
+std::string section_names(uint32_t sections) {
+  if (sections == SECTION_ALL) return "all";
+  std::string names;
+  for (const SectionBand &b : SECTION_BANDS) {
+    if (!(sections & b.section)) continue;
+    if (!names.empty()) names += ", ";
+    names += b.name;
+  }
+  return names.empty() ? "none" : names;
+}
+
+struct Options {
+  std::string out{"frames"};
+  std::string root{".."};
+  int renders{20};
+};
+
+bool parse_args(int argc, char **argv, Options &options) {
+  int opt;
+  while ((opt = getopt(argc, argv, "o:n:f:v")) != -1) {
+    switch (opt) {
+      case 'o': options.out = optarg; break;
+      case 'n': options.renders = std::max(1, std::atoi(optarg)); break;
+      case 'f': options.root = optarg; break;
+      case 'v': host::log_level = 4; break;
+      default: return false;
+    }
+  }
+  return optind == argc;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_args(argc, argv, options)) {
+    std::fprintf(stderr, "Usage: %s [-o out_dir] [-n renders] [-f repo_dir] [-v]\n", argv[0]);
+    return 2;
+  }
+  setenv("TZ", "PST8PDT,M3.2.0,M11.1.0", 1);  // Footer timestamps as on the devices
+  tzset();
+
+  FT_Library library;
+  if (FT_Init_FreeType(&library)) return 1;
+  bool fonts_ok = true;
+  for (const host::FontSpec &spec : HOST_FONTS) fonts_ok &= load_font(library, options.root, spec);
+  FT_Done_FreeType(library);
+  if (!fonts_ok) return 1;
+  if (mkdir(options.out.c_str(), 0755) && errno != EEXIST) {
+    std::fprintf(stderr, "Cannot create %s\n", options.out.c_str());
+    return 1;
+  }
+
+  // on_boot, as far as the display is concerned
+  host::boot(60);
+  host_panel.set_rotation(DISPLAY_ROTATION_90_DEGREES);
+  host_panel.set_auto_clear(false);
+  host_panel.set_writer(display_lambda);
+  eink_panel.set_display(eink_display);
+  eink_text.set_display(eink_display);
+  eink_panel.set_cosmetic_sections(SECTION_FOOTER);
+
+  std::printf("Rendering %zu scenarios to %s/ (render time over %d renders each)\n",
+              sizeof(SCENARIOS) / sizeof(SCENARIOS[0]), options.out.c_str(), options.renders);
+  Canvas previous(WIDTH * HEIGHT, 0);
+  bool displayed_ha_connected = false;
+  int index = 0;
+  auto render = [&](const Scenario &scenario) {
+    host::clock_ms = clock_of(scenario.clock);
+    ha_connected = scenario.ha_connected;
+    if (ha_connected) last_ha_connection_time = homeassistant_time.now().timestamp;
+    apply(scenario);
+
+    // update_screen
+    last_display_refresh_time = homeassistant_time.now().timestamp;
+    data_updated = false;
+    Sensors::take_dirty();
+    Sensors::update_all();
+    uint32_t fallbacks = eink_text.fallbacks();
+    uint32_t required = ha_connected != displayed_ha_connected ? SECTION_FOOTER : SECTION_NONE;
+    PanelRefresh::Result result = eink_panel.begin(false, required);
+    uint32_t first_us = eink_panel.render_us();
+    uint32_t pushed = eink_panel.last_sections();
+    uint32_t allocations = eink_panel.render_allocations();
+    fallbacks = eink_text.fallbacks() - fallbacks;
+    while (!eink_panel.poll()) host::clock_ms += 10;
+    if (result != PanelRefresh::Result::SKIPPED) displayed_ha_connected = ha_connected;
+    Canvas canvas = capture();
+
+    uint32_t min_us = first_us, total_us = 0;
+    for (int i = 1; i < options.renders; i++) {
+      eink_panel.begin(false);
+      while (!eink_panel.poll()) host::clock_ms += 10;
+      min_us = std::min(min_us, eink_panel.render_us());
+      total_us += eink_panel.render_us();
+    }
+
+    char prefix[64];
+    std::snprintf(prefix, sizeof(prefix), "%s/%02d-%s", options.out.c_str(), index++, scenario.name);
+    write_frame(std::string(prefix) + ".png", canvas);
+    write_diff(std::string(prefix) + "-diff.png", previous, canvas, pushed);
+    std::printf("%-14s %-7s render %5uus (min %uus, avg %uus)  pushed: %s\n", scenario.name, result_name(result),
+                (unsigned) first_us, (unsigned) min_us,
+                (unsigned) (options.renders > 1 ? total_us / (options.renders - 1) : first_us),
+                section_names(pushed).c_str());
+    if (allocations) std::printf("    WARNING: display lambda allocated %u times\n", (unsigned) allocations);
+    if (fallbacks) std::printf("    %u strings drawn by the driver (missing glyph)\n", (unsigned) fallbacks);
+    report_diff(previous, canvas, index == 1);
+    previous = std::move(canvas);
+  };
+
+  for (const Scenario &scenario : SCENARIOS) {
+    render(scenario);
+    if (index == 1) std::printf("    static layer rendered once in %uus\n", (unsigned) eink_panel.background_render_us());
+  }
+  return 0;
+}
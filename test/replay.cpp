@@ -0,0 +1,329 @@
+// Replay a recorded HA state stream through the device's SENSOR_LIST on the host.
+//
+//   build/replay-entrance [-r repeat] [-m min_interval_s] [-c coalesce_ms] [-b per_hour:burst]
+//                         [-t entity_id=v1,v2,...] [-v] fixtures/entrance-morning.csv
+//
+// Every line (ms since start, entity_id, state) is published to the sensor's mock
+// component, whose on_value runs SENSOR_UPDATE_CALLBACK exactly as main.cpp does.
+// schedule_refresh/update_screen are modelled from homink-common.inc (min interval,
+// coalesce window, refresh budget, reconnect sync window at t=0), so the refresh
+// count is what the unit would have drawn. Reports callback throughput and cost,
+// allocations per callback, per-sensor trigger rates and a threshold sweep for the
+// numeric and text entities (ThresholdSensor / FilteredTextStateSensor settings).
+
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "host_device.h"  // Last: defines id()
+
+namespace {
+
+struct Record {
+  uint32_t ms;
+  int slot;
+  std::string state;
+};
+
+struct Options {
+  int repeat = 1;
+  uint32_t min_interval_s = 15;     // min_update_interval_seconds
+  uint32_t coalesce_ms = 500;       // coalesce_window_ms
+  uint32_t stale_after_s = 60;      // stale_after_seconds
+  uint32_t sync_timeout_ms = 3000;  // sync_window_timeout
+  float budget_per_hour = 20.0f;    // refresh_budget_per_hour
+  float budget_burst = 10.0f;       // refresh_budget_burst
+  std::map<std::string, std::vector<float>> thresholds;
+  const char *fixture = nullptr;
+};
+
+enum class Kind : uint8_t { NUMERIC, TEXT, BINARY };
+
+template<typename Sensor> constexpr Kind kind_of() {
+  using Component = host::component_t<Sensor>;
+  if (std::is_base_of<esphome::sensor::Sensor, Component>::value) return Kind::NUMERIC;
+  if (std::is_base_of<esphome::text_sensor::TextSensor, Component>::value) return Kind::TEXT;
+  return Kind::BINARY;
+}
+#define HOST_KIND(type, var, sections, ...) kind_of<decltype(var)>(),
+const Kind KINDS[] = {SENSOR_LIST(HOST_KIND)};
+
+bool load_fixture(const char *path, std::vector<Record> &records) {
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "Cannot open %s\n", path);
+    return false;
+  }
+  std::map<std::string, int> unknown;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || !std::isdigit(static_cast<unsigned char>(line[0]))) continue;  // '#' comments, header
+    size_t a = line.find(',');
+    size_t b = a == std::string::npos ? a : line.find(',', a + 1);
+    if (b == std::string::npos) continue;
+    std::string entity = line.substr(a + 1, b - a - 1);
+    int slot = Sensors::find(entity.c_str());
+    if (slot < 0) {
+      unknown[entity]++;
+      continue;
+    }
+    records.push_back({static_cast<uint32_t>(std::stoul(line.substr(0, a))), slot, line.substr(b + 1)});
+  }
+  for (const auto &entry : unknown) {
+    std::fprintf(stderr, "Skipped %d lines for %s (not in SENSOR_LIST)\n", entry.second, entry.first.c_str());
+  }
+  return !records.empty();
+}
+
+// schedule_refresh + update_screen, as far as the sensor state is concerned
+class RefreshModel {
+public:
+  explicit RefreshModel(const Options &options) : _options(options), _tokens(options.budget_burst) {}
+
+  // After every push: a callback that armed schedule_refresh starts its delay
+  void after_push() {
+    if (!schedule_refresh.is_running() || _armed) return;
+    _armed = true;
+    long wait_s = last_display_refresh_time + long(_options.min_interval_s) - homeassistant_time.now().timestamp;
+    uint32_t delay_ms = last_display_refresh_time == 0 || wait_s <= 0 ? 0 : uint32_t(wait_s) * 1000;
+    _fire_ms = host::clock_ms + std::max(delay_ms, _options.coalesce_ms);
+  }
+
+  // Run everything due up to until_ms (timer expiries and the poller's 15s re-arm ticks)
+  void advance(uint32_t until_ms) {
+    while (true) {
+      uint32_t next = _armed ? _fire_ms : data_updated && !Sensors::syncing() ? next_tick_(host::clock_ms) : UINT32_MAX;
+      if (next > until_ms) break;
+      host::clock_ms = std::max(host::clock_ms, next);
+      if (_armed) {
+        fire_();
+      } else {
+        schedule_refresh.execute();  // Poll tick: data_updated && !schedule_refresh.is_running()
+        after_push();
+      }
+    }
+    host::clock_ms = std::max(host::clock_ms, until_ms);
+  }
+
+  uint32_t refreshes() const { return _refreshes; }
+  uint32_t deferred() const { return _deferred; }
+  uint32_t refresh_us() const { return _refresh_us; }
+
+private:
+  uint32_t next_tick_(uint32_t now) const {
+    uint32_t tick = _options.min_interval_s * 1000;
+    return (now / tick + 1) * tick;
+  }
+
+  void fire_() {
+    _armed = false;
+    schedule_refresh.stop();
+    if (!data_updated) return;
+    long now = homeassistant_time.now().timestamp;
+    _tokens = refill_refresh_budget(_tokens, now - _budget_time, _options.budget_per_hour, _options.budget_burst);
+    _budget_time = now;
+    bool exempt = last_display_refresh_time == 0 || (Sensors::dirty_sections() & SECTION_BUDGET_EXEMPT) != 0;
+    if (_tokens < 1.0f && !exempt) {
+      _deferred++;
+      return;
+    }
+    // update_screen: take the dirty flags and cache the values
+    uint32_t start = micros();
+    last_display_refresh_time = now;
+    data_updated = false;
+    Sensors::take_dirty();
+    Sensors::update_all();
+    _refresh_us += micros() - start;
+    _refreshes++;
+    _tokens = std::max(0.0f, _tokens - 1.0f);
+  }
+
+  const Options &_options;
+  bool _armed{false};
+  uint32_t _fire_ms{0};
+  float _tokens;
+  long _budget_time{0};
+  uint32_t _refreshes{0};
+  uint32_t _deferred{0};
+  uint32_t _refresh_us{0};
+};
+
+// 1/2/5 steps between range/500 and range/2 - where a threshold starts to matter
+std::vector<float> default_thresholds(float range) {
+  std::vector<float> steps;
+  if (!(range > 0.0f)) return steps;
+  for (float decade = 0.001f; decade < 1e6f; decade *= 10.0f) {
+    for (float m : {1.0f, 2.0f, 5.0f}) {
+      float t = decade * m;
+      if (t >= range / 500.0f && t <= range / 2.0f) steps.push_back(t);
+    }
+  }
+  if (steps.size() > 8) steps.erase(steps.begin(), steps.end() - 8);
+  return steps;
+}
+
+// Significant changes of one state stream under a standalone sensor (refreshed after
+// every trigger - no min interval, so this is the upper bound the threshold allows)
+template<typename Sensor, typename Component>
+uint32_t count_triggers(Sensor &sensor, Component &component, const std::vector<const Record *> &samples) {
+  sensor.set_sensor(&component);
+  uint32_t triggers = 0;
+  for (const Record *r : samples) {
+    host::publish_text(component, r->state.c_str());
+    sensor.mark_updated();
+    if (sensor.should_trigger_update()) {
+      triggers++;
+      sensor.update();
+    }
+  }
+  return triggers;
+}
+
+void sweep(const Options &options, const std::vector<Record> &records) {
+  std::vector<std::vector<const Record *>> by_slot(Sensors::COUNT);
+  for (const Record &r : records) by_slot[r.slot].push_back(&r);
+  const char *names[Sensors::COUNT];
+  Sensors::for_each([&](auto &sensor) { names[sensor.slot()] = sensor.name(); });
+
+  std::printf("\nThreshold sweep (standalone sensor, every significant change counted):\n");
+  for (int slot = 0; slot < Sensors::COUNT; slot++) {
+    const auto &samples = by_slot[slot];
+    if (samples.empty() || KINDS[slot] == Kind::BINARY) continue;
+    const char *entity = "";
+    Sensors::for_each([&](auto &sensor) {
+      if (sensor.slot() == slot) entity = sensor.entity_id();
+    });
+    std::printf("  %-16s %zu pushes, %u significant with the SENSOR_LIST setting\n", names[slot], samples.size(),
+                (unsigned) Sensors::sensor_at(slot)->triggers());
+
+    if (KINDS[slot] == Kind::NUMERIC) {
+      float lo = INFINITY, hi = -INFINITY;
+      for (const Record *r : samples) {
+        float v = std::strtof(r->state.c_str(), nullptr);
+        if (std::isnan(v)) continue;
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+      }
+      auto custom = options.thresholds.find(entity);
+      std::vector<float> steps = custom != options.thresholds.end() ? custom->second : default_thresholds(hi - lo);
+      for (float t : steps) {
+        esphome::homeassistant::HomeassistantSensor component;
+        FloatThresholdSensor sensor("sweep", entity, t);
+        std::printf("    threshold %-14g %6u\n", t, (unsigned) count_triggers(sensor, component, samples));
+      }
+    } else {
+      std::map<std::string, int> values;
+      for (const Record *r : samples) values[r->state]++;
+      esphome::homeassistant::HomeassistantTextSensor plain_component;
+      TextStateSensor plain("sweep", entity);
+      std::printf("    any change               %6u\n", (unsigned) count_triggers(plain, plain_component, samples));
+      for (const auto &value : values) {
+        esphome::homeassistant::HomeassistantTextSensor component;
+        FilteredTextStateSensor sensor("sweep", entity, value.first.c_str());
+        std::printf("    ignore %-17s %6u  (%d pushes)\n", value.first.c_str(),
+                    (unsigned) count_triggers(sensor, component, samples), value.second);
+      }
+    }
+  }
+}
+
+bool parse_args(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "-v") {
+      host::log_level = 4;
+    } else if (arg == "-r" && has_value) {
+      options.repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "-m" && has_value) {
+      options.min_interval_s = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "-c" && has_value) {
+      options.coalesce_ms = std::atoi(argv[++i]);
+    } else if (arg == "-b" && has_value) {
+      std::sscanf(argv[++i], "%f:%f", &options.budget_per_hour, &options.budget_burst);
+    } else if (arg == "-t" && has_value) {
+      std::string spec = argv[++i];
+      size_t eq = spec.find('=');
+      if (eq == std::string::npos) return false;
+      std::stringstream values(spec.substr(eq + 1));
+      std::string value;
+      while (std::getline(values, value, ',')) options.thresholds[spec.substr(0, eq)].push_back(std::stof(value));
+    } else if (arg[0] != '-' && !options.fixture) {
+      options.fixture = argv[i];
+    } else {
+      return false;
+    }
+  }
+  return options.fixture != nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_args(argc, argv, options)) {
+    std::fprintf(stderr, "usage: %s [-r repeat] [-m min_interval_s] [-c coalesce_ms] [-b per_hour:burst] "
+                         "[-t entity_id=v1,v2,...] [-v] fixture.csv\n", argv[0]);
+    return 2;
+  }
+
+  host::boot(options.stale_after_s);
+  std::vector<Record> records;
+  if (!load_fixture(options.fixture, records)) return 1;
+  uint32_t duration_ms = records.back().ms + 60000;
+
+  RefreshModel refresh(options);
+  uint32_t publish_us = 0;
+  uint32_t publish_allocations = 0;
+  uint32_t max_us = 0;
+  for (int pass = 0; pass < options.repeat; pass++) {
+    uint32_t offset = pass * duration_ms;
+    host::clock_ms = offset;
+    Sensors::begin_sync();  // API connect: HA's state dump arrives first
+    uint32_t sync_end = offset + options.sync_timeout_ms;
+    for (const Record &r : records) {
+      uint32_t at = offset + r.ms;
+      if (Sensors::syncing() && (at >= sync_end || Sensors::sync_complete())) {
+        refresh.advance(std::min(at, sync_end));
+        Sensors::end_sync();
+        if (data_updated && !schedule_refresh.is_running()) schedule_refresh.execute();
+        refresh.after_push();
+      }
+      refresh.advance(at);
+      uint32_t allocs = homink_diag::allocation_count();
+      uint32_t start = micros();
+      HOST_PUBLISHERS[r.slot](r.state.c_str());
+      uint32_t us = micros() - start;
+      publish_us += us;
+      max_us = std::max(max_us, us);
+      publish_allocations += homink_diag::allocation_count() - allocs;
+      refresh.after_push();
+    }
+    refresh.advance(offset + duration_ms);
+  }
+
+  uint32_t callbacks = homink_diag::callback_count;
+  std::printf("Replayed %s: %zu pushes over %.1f min, %d pass(es), %d sensors\n", options.fixture, records.size(),
+              duration_ms / 60000.0f, options.repeat, Sensors::COUNT);
+  std::printf("Callbacks:       %u, %.0f callbacks/s (%.2fus each end to end, max %uus)\n", (unsigned) callbacks,
+              publish_us ? callbacks * 1e6 / publish_us : 0.0, callbacks ? float(publish_us) / callbacks : 0.0f,
+              (unsigned) max_us);
+  std::printf("Change check:    avg %.2fus, max %uus\n", homink_diag::callback_avg_us(),
+              (unsigned) homink_diag::callback_max_us);
+  std::printf("Allocations:     %.3f per callback in the change check, %.3f per push incl. the component\n",
+              callbacks ? float(homink_diag::callback_allocations) / callbacks : 0.0f,
+              callbacks ? float(publish_allocations) / callbacks : 0.0f);
+  std::printf("Refreshes:       %u (%u deferred by the budget), take_dirty + update_all avg %.2fus\n",
+              (unsigned) refresh.refreshes(), (unsigned) refresh.deferred(),
+              refresh.refreshes() ? float(refresh.refresh_us()) / refresh.refreshes() : 0.0f);
+  std::printf("\n  %-16s %8s %12s\n", "sensor", "pushes", "significant");
+  Sensors::for_each([](auto &sensor) {
+    if (!sensor.pushes()) return;
+    std::printf("  %-16s %8u %8u (%2u%%)\n", sensor.name(), (unsigned) sensor.pushes(), (unsigned) sensor.triggers(),
+                (unsigned) (sensor.triggers() * 100 / sensor.pushes()));
+  });
+
+  sweep(options, records);
+  return 0;
+}